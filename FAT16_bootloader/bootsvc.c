@@ -0,0 +1,83 @@
+/*
+ * bootsvc.c
+ *
+ * Created: 10/19/2026
+ *
+ * Flash programming services for the application , see bootsvc.h . Unlike
+ * flash.c nothing here runs in the background : each call programs one page
+ * and returns when it is written and checked .
+ */
+
+#include <avr/io.h>
+#include <avr/boot.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+
+#include "mcu.h"
+#include "bootsvc.h"
+
+#ifndef BOOTSVC_BOOT_START
+   #define BOOTSVC_BOOT_START  MCU_BOOT_START   // Same as .text section start of the bootloader , never written
+#endif
+
+#if (FLASHEND > 0xFFFFUL)
+   #define flash_read_byte(ADD)  pgm_read_byte_far(ADD)
+#else
+   #define flash_read_byte(ADD)  pgm_read_byte((uint16_t)(ADD))
+#endif
+
+// Service table , linked at BOOTSVC_ADDR : word addresses of the entry points .
+// Append only , applications of older builds index it .
+void (* const bootsvc_table[])(void) __attribute__((used , section(".bootsvc"))) =
+{
+	(void (*)(void))bootsvc_do_version ,
+	(void (*)(void))bootsvc_do_program_page ,
+	(void (*)(void))bootsvc_do_verify_page ,
+} ;
+
+uint8_t bootsvc_do_version(void)
+{
+	return BOOTSVC_VERSION ;
+}
+
+uint8_t bootsvc_do_verify_page( uint32_t page , const uint8_t *buf )
+{
+	if(page & (SPM_PAGESIZE - 1))
+	   return BOOTSVC_BAD_ADDRESS ;
+
+	for( uint16_t i = 0 ; i<SPM_PAGESIZE ; i++ )
+	{
+		if(flash_read_byte(page + i) != buf[i])
+		   return BOOTSVC_MISMATCH ;
+	}
+	return BOOTSVC_OK ;
+}
+
+uint8_t bootsvc_do_program_page( uint32_t page , const uint8_t *buf )
+{
+	// Erase and write one page unless it already holds buf , then read it back .
+	uint8_t sreg ;
+
+	if((page & (SPM_PAGESIZE - 1)) || page >= BOOTSVC_BOOT_START)
+	   return BOOTSVC_BAD_ADDRESS ;
+	if(bootsvc_do_verify_page(page , buf) == BOOTSVC_OK)
+	   return BOOTSVC_OK ;
+
+	// Application vectors are in the RWW section : no interrupt until it is readable again .
+	sreg = SREG ;
+	cli() ;
+	eeprom_busy_wait() ;
+
+	for( uint16_t i = 0 ; i<SPM_PAGESIZE ; i+=2 )
+	   boot_page_fill(page + i , buf[i] | (uint16_t)buf[i + 1] << 8) ;
+	boot_page_erase(page) ;
+	boot_spm_busy_wait() ;
+	boot_page_write(page) ;
+	boot_spm_busy_wait() ;
+	boot_rww_enable() ;
+
+	SREG = sreg ;
+
+	return bootsvc_do_verify_page(page , buf) ;
+}
@@ -0,0 +1,64 @@
+/*
+ * bootsvc.h
+ *
+ * Created: 10/19/2026
+ *
+ * Flash programming services of the bootloader , callable by the
+ * application . Only code in the boot section can run SPM , so a game that
+ * loads level code or large const tables into a reserved flash region calls
+ * these through a table of entry points at a fixed address , the same in
+ * every bootloader build :
+ *
+ *   if(bootsvc_version() == BOOTSVC_VERSION)
+ *      status = bootsvc_program_page(0xC000 , page_buf) ;
+ *
+ * Copy this header into the application , it needs only avr-libc and the
+ * device header (FLASHEND) , not mcu.h . The bootloader links bootsvc.c
+ * with (see NOTE in main) :
+ *   -Wl,--section-start=.bootsvc=0xFFE0 -Wl,--undefined=bootsvc_table
+ *
+ * The services use no static data (the application owns the SRAM) and
+ * keep interrupts disabled while a page is erased and written (~8 ms) ,
+ * the application vectors are in the RWW section .
+ */
+
+
+#ifndef BOOTSVC_H_
+#define BOOTSVC_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+/*========== Constants ==========================*/
+
+#define BOOTSVC_VERSION        1
+#define BOOTSVC_SIZE           32                                // Bytes reserved for the table , 16 entries
+#define BOOTSVC_ADDR           (FLASHEND + 1UL - BOOTSVC_SIZE)   // Table byte address , 0xFFE0 on ATmega644P
+
+// bootsvc_program_page() / bootsvc_verify_page() results
+#define BOOTSVC_OK             0
+#define BOOTSVC_BAD_ADDRESS    1   // Not page aligned or inside the boot section
+#define BOOTSVC_MISMATCH       2   // Flash differs from the buffer (after programming : write failed)
+
+/*========== Application side ==========================*/
+
+// Entry n of the table is the word address of a service , as function pointers are .
+#if (FLASHEND > 0xFFFFUL)
+   #define BOOTSVC_ENTRY(N)    pgm_read_word_far(BOOTSVC_ADDR + 2 * (N))
+#else
+   #define BOOTSVC_ENTRY(N)    pgm_read_word((uint16_t)(BOOTSVC_ADDR + 2 * (N)))
+#endif
+
+#define bootsvc_version        ( (uint8_t (*)(void)) BOOTSVC_ENTRY(0) )
+#define bootsvc_program_page   ( (uint8_t (*)(uint32_t , const uint8_t *)) BOOTSVC_ENTRY(1) )
+#define bootsvc_verify_page    ( (uint8_t (*)(uint32_t , const uint8_t *)) BOOTSVC_ENTRY(2) )
+
+/*========== Bootloader side ==========================*/
+
+uint8_t bootsvc_do_version(void) ;
+uint8_t bootsvc_do_program_page( uint32_t page , const uint8_t *buf ) ;
+uint8_t bootsvc_do_verify_page( uint32_t page , const uint8_t *buf ) ;
+
+
+#endif /* BOOTSVC_H_ */
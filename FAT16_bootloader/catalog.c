@@ -0,0 +1,170 @@
+/*
+ * catalog.c
+ *
+ * Created: 10/19/2026
+ *
+ * Game catalog reader , see catfmt.h for the layout .
+ */
+
+#include "catalog.h"
+#include "diskio.h"
+
+#define CT_BURST	(512 / CAT_REC_SIZE)	/* Records listed per read, one sector */
+
+static BYTE rec[CAT_REC_SIZE];		/* Record being assembled */
+static WORD rec_fill;
+static CAT_LIST list_cb;
+static WORD list_idx;
+static CAT_ENTRY list_ent;
+
+
+static void ct_decode (
+	const BYTE *p,		/* Pointer to a raw game record */
+	CAT_ENTRY *ce		/* Pointer to the decoded record */
+)
+{
+	BYTE i;
+
+
+	for (i = 0; i < CAT_TITLE_SIZE; i++) ce->title[i] = p[CAT_ENT_TITLE+i];
+	ce->title[CAT_TITLE_SIZE-1] = 0;
+	for (i = 0; i < CAT_NAME_SIZE; i++) ce->name[i] = p[CAT_ENT_NAME+i];
+	ce->name[CAT_NAME_SIZE-1] = 0;
+	ce->sclust = (CLUST)LD_DWORD(p+CAT_ENT_CLUST);
+	ce->size = LD_DWORD(p+CAT_ENT_SIZE);
+	ce->crc = LD_DWORD(p+CAT_ENT_CRC);
+	ce->thumb = LD_DWORD(p+CAT_ENT_THUMB);
+}
+
+
+static void ct_sink (
+	const BYTE *data,	/* Forwarded catalog bytes */
+	UINT count
+)
+{
+	while (count--) {
+		rec[rec_fill++] = *data++;
+		if (rec_fill == CAT_REC_SIZE) {		/* A whole record, hand it to the menu */
+			ct_decode(rec, &list_ent);
+			list_cb(list_idx++, &list_ent);
+			rec_fill = 0;
+		}
+	}
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Open a Catalog                                                        */
+/*-----------------------------------------------------------------------*/
+
+FRESULT ct_open (
+	CATALOG *ct,		/* Pointer to the catalog object to initialize */
+	const char *path	/* Pointer to the catalog file name */
+)
+{
+	FRESULT res;
+	WORD br;
+
+
+	res = pf_fopen(&ct->fil, path);
+	if (res != FR_OK) return res;
+
+	res = pf_fread(&ct->fil, rec, CAT_REC_SIZE, &br);
+	if (res != FR_OK) return res;
+	ct->count = LD_WORD(rec+CAT_HDR_COUNT);
+	if (br != CAT_REC_SIZE ||
+		LD_DWORD(rec+CAT_HDR_MAGIC) != CAT_MAGIC ||
+		LD_WORD(rec+CAT_HDR_VERSION) != CAT_VERSION ||
+		ct->fil.fsize < ((DWORD)ct->count + 1) * CAT_REC_SIZE)
+		return FR_NO_FILESYSTEM;
+
+	return FR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* List Game Records                                                     */
+/*-----------------------------------------------------------------------*/
+/* Records are forwarded from the disk driver a sector at a time, a menu
+/  page costs one or two sector reads however long the catalog is. */
+
+FRESULT ct_list (
+	CATALOG *ct,		/* Pointer to the open catalog */
+	WORD first,			/* First game to list */
+	WORD count,			/* Number of games to list */
+	CAT_LIST func		/* Callback receiving each record */
+)
+{
+	FRESULT res;
+	WORD n, br;
+
+
+	if (first >= ct->count) return FR_OK;
+	if (count > ct->count - first) count = ct->count - first;
+
+	res = pf_flseek(&ct->fil, (DWORD)(first + 1) * CAT_REC_SIZE);
+	list_cb = func;
+	list_idx = first;
+	rec_fill = 0;
+	disk_set_block_sink(ct_sink);
+	while (res == FR_OK && count) {
+		n = (count > CT_BURST) ? CT_BURST : count;
+		res = pf_fread(&ct->fil, 0, n * CAT_REC_SIZE, &br);
+		if (res == FR_OK && br != n * CAT_REC_SIZE) res = FR_DISK_ERR;
+		count -= n;
+	}
+	disk_set_block_sink(0);
+
+	return res;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read a Game Record                                                    */
+/*-----------------------------------------------------------------------*/
+
+FRESULT ct_read (
+	CATALOG *ct,		/* Pointer to the open catalog */
+	WORD idx,			/* Game index */
+	CAT_ENTRY *ce		/* Pointer to store the record */
+)
+{
+	FRESULT res;
+	WORD br;
+
+
+	if (idx >= ct->count) return FR_NO_FILE;
+
+	res = pf_flseek(&ct->fil, (DWORD)(idx + 1) * CAT_REC_SIZE);
+	if (res == FR_OK) res = pf_fread(&ct->fil, rec, CAT_REC_SIZE, &br);
+	if (res != FR_OK) return res;
+	if (br != CAT_REC_SIZE) return FR_DISK_ERR;
+	ct_decode(rec, ce);
+
+	return FR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Open a Game File                                                      */
+/*-----------------------------------------------------------------------*/
+/* The file is opened by its recorded start cluster and size, a catalog left
+/  stale by later changes to the card is refused with FR_NO_FILE when the
+/  cluster chain no longer fits the size. The file data is not read here,
+/  its content is checked by the image CRC after programming. */
+
+FRESULT ct_open_game (
+	const CAT_ENTRY *ce,	/* Pointer to the game record */
+	FIL *fp					/* Pointer to the blank file object */
+)
+{
+	return pf_fopen_clust(fp, ce->sclust, ce->size);
+}
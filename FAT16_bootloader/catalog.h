@@ -0,0 +1,44 @@
+/*
+ * catalog.h
+ *
+ * Created: 10/19/2026
+ *
+ * Game catalog reader . The menu is listed from a few sector reads of
+ * CATALOG.DAT and a game is opened by its recorded start cluster , the
+ * "files" directory is never searched .
+ */
+
+
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include "pff.h"
+#include "catfmt.h"
+
+/*========== Data structures ==========================*/
+
+typedef struct {
+	FIL		fil;		/* Catalog file */
+	WORD	count;		/* Number of games */
+} CATALOG;
+
+typedef struct {
+	char	title[CAT_TITLE_SIZE];	/* Menu title */
+	char	name[CAT_NAME_SIZE];	/* File name in the "files" directory */
+	CLUST	sclust;		/* Start cluster of the game file */
+	DWORD	size;		/* Game file size */
+	DWORD	crc;		/* CRC-32 of the game file (not checked on the target) */
+	DWORD	thumb;		/* Thumbnail offset in the game file (0: none) */
+} CAT_ENTRY;
+
+typedef void (*CAT_LIST)(WORD, const CAT_ENTRY*);	/* Receives the index and the record of a listed game */
+
+/*========== Functions prototypes ==========================*/
+
+FRESULT ct_open (CATALOG*, const char*);				/* Open a catalog file */
+FRESULT ct_list (CATALOG*, WORD, WORD, CAT_LIST);	/* Stream a range of game records to a callback */
+FRESULT ct_read (CATALOG*, WORD, CAT_ENTRY*);		/* Read one game record */
+FRESULT ct_open_game (const CAT_ENTRY*, FIL*);		/* Open a game file by cluster and check its cluster chain */
+
+
+#endif /* CATALOG_H_ */
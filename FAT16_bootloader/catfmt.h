@@ -0,0 +1,49 @@
+/*
+ * catfmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * Game catalog file (CATALOG.DAT in the card root) . Shared by catalog.c
+ * and tools/mkcatalog.c .
+ *
+ *  record 0   : header
+ *  record 1.. : one record per game , in menu order
+ *
+ * Records are 64 bytes , 8 per sector , so the header and the first 15
+ * games are read with two sector reads . A game record holds the start
+ * cluster of the game file , the launcher opens it without searching the
+ * directory . The catalog is built on the host from the card itself and
+ * must be rebuilt whenever files are added , removed or rewritten .
+ *
+ * All multi-byte fields are little-endian .
+ */
+
+
+#ifndef CATFMT_H_
+#define CATFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define CAT_MAGIC               0x54414347UL   // "GCAT"
+#define CAT_VERSION             1
+#define CAT_REC_SIZE            64
+#define CAT_TITLE_SIZE          32   // Including the terminating NUL
+#define CAT_NAME_SIZE           16   // 8.3 file name , NUL padded
+
+// Header record byte offsets
+#define CAT_HDR_MAGIC           0    // 4 bytes
+#define CAT_HDR_VERSION         4    // 2 bytes
+#define CAT_HDR_COUNT           6    // 2 bytes , number of game records
+
+// Game record byte offsets
+#define CAT_ENT_TITLE           0    // CAT_TITLE_SIZE bytes , NUL terminated
+#define CAT_ENT_NAME            32   // CAT_NAME_SIZE bytes , file name in the "files" directory
+#define CAT_ENT_CLUST           48   // 4 bytes , start cluster
+#define CAT_ENT_SIZE            52   // 4 bytes , file size in bytes
+#define CAT_ENT_CRC             56   // 4 bytes , CRC-32 of the whole file (see crc.h)
+#define CAT_ENT_THUMB           60   // 4 bytes , thumbnail offset in the file , 0 = none
+
+
+#endif /* CATFMT_H_ */
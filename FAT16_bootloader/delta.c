@@ -0,0 +1,153 @@
+/*
+ * delta.c
+ *
+ * Created: 10/19/2026
+ *
+ * In-place delta patcher (see deltafmt.h) . SRAM use is a few state bytes
+ * and a DELTA_COPY_CHUNK byte copy buffer , pages are assembled in the
+ * flash pipeline buffers .
+ */
+
+#include <avr/io.h>
+
+#include "flash.h"
+#include "delta.h"
+
+#define DELTA_ST_OP       0
+#define DELTA_ST_ARGS     1
+#define DELTA_ST_DATA     2
+#define DELTA_ST_END      3
+
+static uint8_t state , status ;
+static uint8_t op , args[5] , args_count , args_needed ;
+static uint16_t data_left ;
+static uint32_t dst , limit_addr ;
+
+static uint32_t ld32( const uint8_t *p )
+{
+	return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24 ;
+}
+
+static void delta_copy( uint32_t src , uint16_t len )
+{
+	uint8_t chunk[DELTA_COPY_CHUNK] ;
+
+	// Source must still hold old content : at or above the page being rebuilt , and when
+	// it lies behind the destination the copy must not leave that page .
+	uint32_t page_start = dst & ~(uint32_t)(SPM_PAGESIZE - 1) ;
+
+	if(src < page_start || (src < dst && dst + len > page_start + SPM_PAGESIZE) || dst + len > limit_addr)
+	{
+		status = DELTA_BAD_RANGE ;
+		state = DELTA_ST_END ;
+		return ;
+	}
+
+	while(len)
+	{
+		uint8_t n = (len < DELTA_COPY_CHUNK) ? len : DELTA_COPY_CHUNK ;
+		flash_read(src , chunk , n) ;
+		flash_write(dst , chunk , n) ;
+		src += n ;
+		dst += n ;
+		len -= n ;
+	}
+}
+
+static void delta_args_done(void)
+{
+	if(op == DELTA_OP_COPY)
+	{
+		delta_copy(args[0] | (uint32_t)args[1] << 8 | (uint32_t)args[2] << 16 , args[3] | (uint16_t)args[4] << 8) ;
+		if(state != DELTA_ST_END)
+		   state = DELTA_ST_OP ;
+	}
+	else
+	{
+		data_left = args[0] | (uint16_t)args[1] << 8 ;
+		if(dst + data_left > limit_addr)
+		{
+			status = DELTA_BAD_RANGE ;
+			state = DELTA_ST_END ;
+		}
+		else
+		   state = data_left ? DELTA_ST_DATA : DELTA_ST_OP ;
+	}
+}
+
+uint8_t delta_parse_header( const uint8_t *hdr , DELTA_INFO *info )
+{
+	// 0 if hdr starts a delta patch .
+	if(ld32(hdr + DELTA_HDR_MAGIC) != DELTA_MAGIC)
+	   return 1 ;
+
+	info->base_length = ld32(hdr + DELTA_HDR_BASE_LENGTH) ;
+	info->base_crc    = ld32(hdr + DELTA_HDR_BASE_CRC) ;
+	info->length      = ld32(hdr + DELTA_HDR_LENGTH) ;
+	info->crc         = ld32(hdr + DELTA_HDR_CRC) ;
+	return 0 ;
+}
+
+void delta_init( uint32_t limit )
+{
+	// Ops start right after the header , the new image is rebuilt from address 0 .
+	limit_addr = limit ;
+	dst = 0 ;
+	state = DELTA_ST_OP ;
+	status = DELTA_BUSY ;
+}
+
+void delta_feed( const uint8_t *data , uint16_t count )
+{
+	while(count && state != DELTA_ST_END)
+	{
+		switch(state)
+		{
+			case DELTA_ST_OP :
+				op = *data++ ;
+				count-- ;
+				args_count = 0 ;
+				if(op == DELTA_OP_COPY)
+				{
+					args_needed = 5 ;
+					state = DELTA_ST_ARGS ;
+				}
+				else if(op == DELTA_OP_INSERT)
+				{
+					args_needed = 2 ;
+					state = DELTA_ST_ARGS ;
+				}
+				else
+				{
+					status = (op == DELTA_OP_END) ? DELTA_DONE : DELTA_BAD_OP ;
+					state = DELTA_ST_END ;
+				}
+				break ;
+
+			case DELTA_ST_ARGS :
+				args[args_count++] = *data++ ;
+				count-- ;
+				if(args_count == args_needed)
+				   delta_args_done() ;
+				break ;
+
+			case DELTA_ST_DATA :
+			{
+				// Insert as many bytes as this chunk holds in one go .
+				uint16_t n = (count < data_left) ? count : data_left ;
+				flash_write(dst , data , n) ;
+				dst += n ;
+				data += n ;
+				count -= n ;
+				data_left -= n ;
+				if(!data_left)
+				   state = DELTA_ST_OP ;
+			}break ;
+		}
+	}
+}
+
+uint8_t delta_status(void)
+{
+	return status ;
+}
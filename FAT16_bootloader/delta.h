@@ -0,0 +1,48 @@
+/*
+ * delta.h
+ *
+ * Created: 10/19/2026
+ *
+ * In-place delta patcher (see deltafmt.h) . The patch is pushed in any
+ * chunk size , every page of the new image is rebuilt from current flash
+ * and patch data by flash_write() , unchanged pages are skipped by the
+ * flash pipeline .
+ */
+
+
+#ifndef DELTA_H_
+#define DELTA_H_
+
+#include <stdint.h>
+
+#include "deltafmt.h"
+
+/*========== Constants ==========================*/
+
+#define DELTA_COPY_CHUNK    16   // Bytes read from flash per flash_write() while copying .
+
+// delta_status() values
+#define DELTA_BUSY          0
+#define DELTA_DONE          1   // END op seen , further input is ignored
+#define DELTA_BAD_OP        2
+#define DELTA_BAD_RANGE     3   // Writes at or above the limit , or copies from a page already rewritten
+
+/*========== Types ==========================*/
+
+typedef struct
+{
+	uint32_t base_length ;
+	uint32_t base_crc ;
+	uint32_t length ;
+	uint32_t crc ;
+}DELTA_INFO ;
+
+/*========== Functions prototypes ==========================*/
+
+uint8_t delta_parse_header( const uint8_t *hdr , DELTA_INFO *info ) ;
+void delta_init( uint32_t limit ) ;
+void delta_feed( const uint8_t *data , uint16_t count ) ;
+uint8_t delta_status(void) ;
+
+
+#endif /* DELTA_H_ */
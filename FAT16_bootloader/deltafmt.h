@@ -0,0 +1,50 @@
+/*
+ * deltafmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * Delta patch format . Shared by delta.c and tools/mkdelta.c .
+ *
+ *  header : magic , base length , base CRC , new length , new CRC
+ *  ops    : rebuild the new image from address 0 upwards
+ *           COPY   src (3 bytes) , len (2 bytes)  : len bytes of the CURRENT flash from src
+ *           INSERT len (2 bytes) , len data bytes : new bytes
+ *           END
+ *
+ * The patch is applied in place , pages are rewritten in ascending order .
+ * Every byte a COPY reads must still be old flash : src must be at or above
+ * the start of the page holding dst , and a COPY with src below dst must end
+ * in that page . mkdelta enforces it for the page size given on its command
+ * line .
+ *
+ * CRCs are CRC-32 (see crc.h) . Base values describe the image the patch
+ * was made against , it is refused when flash does not match them .
+ *
+ * All multi-byte fields are little-endian .
+ */
+
+
+#ifndef DELTAFMT_H_
+#define DELTAFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define DELTA_MAGIC             0x31504447UL   // "GDP1"
+
+// Header byte offsets
+#define DELTA_HDR_MAGIC         0    // 4 bytes
+#define DELTA_HDR_BASE_LENGTH   4    // 4 bytes
+#define DELTA_HDR_BASE_CRC      8    // 4 bytes
+#define DELTA_HDR_LENGTH        12   // 4 bytes
+#define DELTA_HDR_CRC           16   // 4 bytes
+#define DELTA_HDR_SIZE          20
+
+// Op codes
+#define DELTA_OP_END            0x00
+#define DELTA_OP_COPY           0x01
+#define DELTA_OP_INSERT         0x02
+
+
+#endif /* DELTAFMT_H_ */
@@ -5,11 +5,18 @@
  *  Author: Islam Gamal
  */ 
 
+#include <avr/eeprom.h>
+
 #include "spi.h"
 #include "diskio.h"
+#include "trace.h"
 
 int cmd_iterations = 0 ; 
 
+static DISK_SINK       forward_sink ;        // Byte sink used when disk_readp() gets a NULL buffer .
+static DISK_BLOCK_SINK forward_block_sink ;  // Burst sink , takes priority over the byte sink .
+static DISK_IDLE       idle_hook ;           // Background work run while waiting for read data .
+
 static uint8_t SD_Send_Command(uint8_t command , uint32_t address) 
 {
 	
@@ -24,6 +31,9 @@ static uint8_t SD_Send_Command(uint8_t command , uint32_t address)
 	
 	spi_write(0x95) ;
 	
+	if(command == SD_STOP_TRAN_CMD)
+	   spi_read(0xFF) ;   // Skip the stuff byte sent while stopping a multiple block read .
+	
 	// Wait for response
 	
 	uint8_t response = 0xFF ;
@@ -43,6 +53,64 @@ static uint8_t SD_Send_Command(uint8_t command , uint32_t address)
 }
 
 
+static uint8_t wait_data_token(void)
+{
+	// Wait for data token response from SD card , returns 0xFE on success .
+	uint8_t response = 0xFF ;
+	
+	for( uint16_t i = 0 ; i <READ_DATATOKEN_ITERATION_RESPONSE ; i++ )
+	{
+		response = spi_read(0xFF) ;
+		
+		if (response == 0xFE) 
+		   break ;  
+		if(idle_hook) idle_hook() ;
+	}
+	
+	return response ;
+}
+
+
+static void receive_data(BYTE *buff , UINT count)
+{
+	// Store received bytes in buff , or forward them to the registered sink when buff is NULL .
+	UINT i ;
+	
+	if(buff)
+	{
+		for( i = 0 ; i< count ; i++ )
+		{
+			buff[i] = spi_read(0xFF) ;
+			if(idle_hook && (i % DISK_IDLE_INTERVAL) == DISK_IDLE_INTERVAL - 1) idle_hook() ;
+		}
+	}
+	else if(forward_block_sink)
+	{
+		BYTE burst[DISK_FORWARD_BURST] ;
+		while(count)
+		{
+			UINT n = (count < DISK_FORWARD_BURST) ? count : DISK_FORWARD_BURST ;
+			for( i = 0 ; i< n ; i++ )
+			{
+				burst[i] = spi_read(0xFF) ;
+			}
+			forward_block_sink(burst , n) ;
+			count -= n ;
+			if(idle_hook) idle_hook() ;
+		}
+	}
+	else
+	{
+		for( i = 0 ; i< count ; i++ )
+		{
+			BYTE d = spi_read(0xFF) ;
+			if(forward_sink) forward_sink(d) ;
+			if(idle_hook && (i % DISK_IDLE_INTERVAL) == DISK_IDLE_INTERVAL - 1) idle_hook() ;
+		}
+	}
+}
+
+
 /*--------------------------------------------------------------------------
    Public Functions
 ---------------------------------------------------------------------------*/
@@ -57,7 +125,7 @@ DSTATUS disk_initialize(void)
 	
 	//1- Initialize SPI mode for MCU .
 	
-	spi_init(SPI_FOSC_32) ; 
+	spi_init(SPI_FOSC_32 , MASTER) ; 
 
 	uint8_t response = 0xFF ;
    
@@ -131,38 +199,33 @@ DRESULT disk_readp (
 {
 	DRESULT res = RES_OK ;
 	
+	TRACE(TRACE_SD_READ , sector) ;
 	assert_CS() ;
 	uint8_t response = SD_Send_Command(SD_READ_SECTOR_CMD , ((uint32_t)sector) << 9U) ;
 	
 	if(response != READ_RESPONSE_OK )
-	  res = RES_ERROR;  // Read Failed
-	
-	// 2-Wait for data token response from SD card
-      uint16_t i  ;
-	for(  i = 0 ; i <READ_DATATOKEN_ITERATION_RESPONSE ; i++ )
 	{
-		response = spi_read(0xFF) ;
-		
-		if (response == 0xFE) 
-		   break ;  
+	  de_assert_CS() ;
+	  TRACE(TRACE_SD_DONE , 0xFFFF) ;
+	  return RES_ERROR;  // Read Failed
 	}
 	
-	if( response != 0xFE )
+	// 2-Wait for data token response from SD card , the idle hook runs meanwhile .
+	if( wait_data_token() != 0xFE )
 	   {
-		 	
-		  res  =RES_ERROR  ;  // Means failed operation .
+		  // Do not clock out the sector , in forward mode garbage would reach the sink .
+		  de_assert_CS() ;
+		  TRACE(TRACE_SD_DONE , 0xFFFF) ;
+		  return RES_ERROR  ;  // Means failed operation .
 	   }
        uint16_t final_discard = 512 - (offset+count) ;
 	   // Discard bytes from sector_offset to offset 
 
        while(offset--) spi_read(0xFF) ;
 	   
-	   //3- Start receive 512 byte data from SD card .
+	   //3- Start receive data from SD card into buff or forward it to the registered sink .
 	   
-	   for( i = 0 ; i< count ; i++ )
-	   {
-		   buff[i] = spi_read(0xFF) ;
-	   }
+	   receive_data(buff , count) ;
 	   
 	    //Discard bytes from (sector_offset + offset) to 512
 
@@ -178,6 +241,281 @@ DRESULT disk_readp (
 	   
 	   //6- De-assert chip
 	   de_assert_CS() ;
+	   TRACE(TRACE_SD_DONE , 0) ;
 	   
 	   return res ; // means no errors
 }
+
+
+/*-----------------------------------------------------------------------*/
+/* Read consecutive whole sectors                                        */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_readm (
+	BYTE *buff,		/* Pointer to the read buffer (NULL:Read bytes are forwarded to the stream) */
+	DWORD sector,	/* Start sector number (LBA) */
+	UINT count		/* Number of sectors to read */
+)
+{
+	DRESULT res = RES_OK ;
+	
+	if( !count )
+	   return RES_OK ;
+	
+	// 1- One command for the whole run , the card streams sectors back to back .
+	TRACE(TRACE_SD_READ , sector) ;
+	assert_CS() ;
+	if( SD_Send_Command(SD_READ_MULTI_CMD , sector << 9) != READ_RESPONSE_OK )
+	{
+		de_assert_CS() ;
+		TRACE(TRACE_SD_DONE , 0xFFFF) ;
+		return RES_ERROR ;
+	}
+	
+	// 2- Every sector comes as data token , 512 byte and 16-bit CRC .
+	while( count-- )
+	{
+		if( wait_data_token() != 0xFE )
+		{
+			res = RES_ERROR ;
+			break ;
+		}
+		receive_data(buff , SECTOR_SIZE) ;
+		if(buff) buff += SECTOR_SIZE ;
+		spi_read(0xFF) ;
+		spi_read(0xFF) ;
+	}
+	
+	// 3- Stop transmission and wait while card leaves busy state .
+	SD_Send_Command(SD_STOP_TRAN_CMD , 0x00) ;
+	
+	uint16_t iterations = 0 ;
+	while( spi_read(0xFF) != 0xFF && iterations++ < WRITE_BUSY_ITERATION ) ;
+	
+	de_assert_CS() ;
+	TRACE(TRACE_SD_DONE , res ? 0xFFFF : 0) ;
+	
+	return res ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Send one data block of a write transaction                            */
+/*-----------------------------------------------------------------------*/
+
+static DRESULT send_block_end(void)
+{
+	// Dummy 16-bit CRC (ignored in SPI mode) then check data response token .
+	spi_write(0xFF) ;
+	spi_write(0xFF) ;
+	
+	if( (spi_read(0xFF) & 0x0F) != WRITE_RESPONSE_ACCEPTED )
+	   return RES_ERROR ;
+	
+	// Wait while card is busy programming (MISO held low) .
+	uint16_t iterations = 0 ;
+	while( spi_read(0xFF) != 0xFF )
+	{
+		if( iterations++ >= WRITE_BUSY_ITERATION )
+		   return RES_ERROR ;
+	}
+	
+	return RES_OK ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Write partial sector                                                  */
+/*-----------------------------------------------------------------------*/
+
+static UINT write_remain ;   // Bytes left in the sector being written by disk_writep() .
+
+DRESULT disk_writep (
+	const BYTE *buff,	/* Pointer to the bytes to be written (NULL:Initiate/Finalize sector write) */
+	DWORD sc			/* Number of bytes to send, Sector number (LBA) or zero */
+)
+{
+	if(buff)		/* Send data bytes */
+	{
+		while( sc-- && write_remain )
+		{
+			spi_write(*buff++) ;
+			write_remain-- ;
+		}
+		return RES_OK ;
+	}
+	
+	if(sc)			/* Initiate sector write */
+	{
+		assert_CS() ;
+		if( SD_Send_Command(SD_WRITE_SECOTR_CMD , sc << 9) != WRITE_RESPONSE_OK )
+		{
+			de_assert_CS() ;
+			return RES_ERROR ;
+		}
+		spi_write(WRITE_SINGLE_TOKEN) ;
+		write_remain = SECTOR_SIZE ;
+		return RES_OK ;
+	}
+	
+	/* Finalize sector write , left bytes are filled with zeros */
+	while( write_remain )
+	{
+		spi_write(0x00) ;
+		write_remain-- ;
+	}
+	DRESULT res = send_block_end() ;
+	de_assert_CS() ;
+	
+	return res ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Write consecutive whole sectors                                       */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_writem (
+	const BYTE *buff,	/* Pointer to the data to be written (count * 512 bytes) */
+	DWORD sector,		/* Start sector number (LBA) */
+	UINT count			/* Number of sectors to write */
+)
+{
+	DRESULT res = RES_OK ;
+	
+	if( !count )
+	   return RES_OK ;
+	
+	assert_CS() ;
+	
+	// 1- Tell SD card how many sectors follow so it can pre-erase them (ACMD23) . MMC cards reject CMD55 , so skip it .
+	if( SD_Send_Command(SD_APP_CMD , 0x00) <= 0x01 )
+	   SD_Send_Command(SD_SET_WR_BLK_ERASE_CMD , count) ;
+	
+	// 2- One command for the whole run , no per sector command and finalization .
+	if( SD_Send_Command(SD_WRITE_MULTI_CMD , sector << 9) != WRITE_RESPONSE_OK )
+	{
+		de_assert_CS() ;
+		return RES_ERROR ;
+	}
+	
+	while( count-- )
+	{
+		spi_write(WRITE_MULTI_TOKEN) ;
+		for( uint16_t i = 0 ; i< SECTOR_SIZE ; i++ )
+		{
+			spi_write(*buff++) ;
+		}
+		if( send_block_end() != RES_OK )
+		{
+			res = RES_ERROR ;
+			break ;
+		}
+	}
+	
+	// 3- Stop transmission token and wait while card finishes the last sector .
+	spi_write(STOP_TRAN_TOKEN) ;
+	spi_read(0xFF) ;
+	
+	uint16_t iterations = 0 ;
+	while( spi_read(0xFF) != 0xFF && iterations++ < WRITE_BUSY_ITERATION ) ;
+	
+	spi_write(0xFF) ;
+	de_assert_CS() ;
+	
+	return res ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Register stream sinks for forward mode                                */
+/*-----------------------------------------------------------------------*/
+
+void disk_set_sink (
+	DISK_SINK sink		/* Called once per received byte (NULL: discard) */
+)
+{
+	forward_sink = sink ;
+}
+
+
+void disk_set_block_sink (
+	DISK_BLOCK_SINK sink	/* Called with up to DISK_FORWARD_BURST bytes (NULL: use byte sink) */
+)
+{
+	forward_block_sink = sink ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Register background work for read waits                               */
+/*-----------------------------------------------------------------------*/
+
+void disk_set_idle (
+	DISK_IDLE hook		/* Called while waiting for and receiving data (NULL: none) */
+)
+{
+	idle_hook = hook ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Read the card identification register                                */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_read_cid (
+	BYTE *cid		/* Pointer to a 16 byte buffer to store the CID */
+)
+{
+	assert_CS() ;
+	uint8_t response = SD_Send_Command(SD_SEND_CID_CMD , 0x00) ;
+	
+	if(response != READ_RESPONSE_OK )
+	{
+		de_assert_CS() ;
+		return RES_ERROR ;
+	}
+	
+	// CID is sent as a 16 byte data block with the same token as a sector read .
+	if( wait_data_token() != 0xFE )
+	{
+		de_assert_CS() ;
+		return RES_ERROR ;
+	}
+	
+	for( uint8_t i = 0 ; i< 16 ; i++ )
+	{
+		cid[i] = spi_read(0xFF) ;
+	}
+	
+	// Discard 16-bit CRC and finish the transaction .
+	spi_read(0xFF) ;
+	spi_read(0xFF) ;
+	spi_write(0xFF) ;
+	de_assert_CS() ;
+	
+	return RES_OK ;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Load / store the mount cache in EEPROM                                */
+/*-----------------------------------------------------------------------*/
+
+void disk_cache_load (
+	void *dst,		/* Pointer to the cache image in RAM */
+	UINT len		/* Size of the cache image */
+)
+{
+	eeprom_read_block(dst , (const void *)DISK_CACHE_EEADDR , len) ;
+}
+
+
+void disk_cache_store (
+	const void *src,	/* Pointer to the cache image in RAM */
+	UINT len			/* Size of the cache image */
+)
+{
+	// Update only writes cells that changed , so remounting the same card costs no EEPROM wear .
+	eeprom_update_block(src , (void *)DISK_CACHE_EEADDR , len) ;
+}
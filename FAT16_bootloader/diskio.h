@@ -33,9 +33,14 @@ typedef enum {
 #define GO_IDLE_STATE          ( 0x00 + 0x40 )   // To make SD card go to SPI mode . 
 #define SEND_OP_COND           ( 0x01 + 0x40 )   // Activates the card’s initialization process
 #define SD_READ_SECTOR_CMD     ( 0x11 + 0x40 ) 
+#define SD_READ_MULTI_CMD      ( 0x12 + 0x40 )   // Read consecutive sectors until CMD12 .
+#define SD_STOP_TRAN_CMD       ( 0x0C + 0x40 )   // Stop a multiple block read .
 #define SD_WRITE_SECOTR_CMD    ( 0x18 + 0x40 )
 #define SD_APP_CMD             ( 0x37 + 0x40 )
 #define SD_SEND_OP_CMD         ( 0x29 + 0x40 )
+#define SD_SEND_CID_CMD        ( 0x0A + 0x40 )   // Read the 16 byte card identification register
+#define SD_WRITE_MULTI_CMD     ( 0x19 + 0x40 )   // Write consecutive sectors until stop token .
+#define SD_SET_WR_BLK_ERASE_CMD ( 0x17 + 0x40 )  // ACMD23 : number of blocks to pre-erase before multi write .
 
 //Responses values from SD Data sheet
 
@@ -45,6 +50,11 @@ typedef enum {
 #define WRITE_CRC_REJECTED      0x0B
 #define WRITE_ERROR_REJECTED    0x0D
 
+#define WRITE_SINGLE_TOKEN      0xFE
+#define WRITE_MULTI_TOKEN       0xFC
+#define STOP_TRAN_TOKEN         0xFD
+#define WRITE_BUSY_ITERATION    50000U  // Card may stay busy up to 250 ms while programming .
+
 #define STA_NOINIT		0x01	/* Drive not initialized */
 #define STA_NODISK		0x02	/* No medium in the drive */
 
@@ -55,11 +65,34 @@ typedef enum {
 #define CT_SDC				(CT_SD1|CT_SD2)	/* SD */
 #define CT_BLOCK			0x08	/* Block addressing */
 
+/* Stream forwarding (pf_read with a NULL buffer) */
+#define DISK_FORWARD_BURST	16		/* Max bytes handed to a block sink per call */
+
+typedef void (*DISK_SINK)(BYTE);					/* Receives one forwarded byte */
+typedef void (*DISK_BLOCK_SINK)(const BYTE*, UINT);	/* Receives a burst of forwarded bytes */
+
+/* Background work while waiting on the card */
+#define DISK_IDLE_INTERVAL	16		/* Bytes received between idle calls */
+
+typedef void (*DISK_IDLE)(void);				/* Called while a read is in progress */
+
+/* Non-volatile mount cache (see _USE_MOUNT_CACHE in pff.h) */
+#define DISK_CACHE_EEADDR	0x0000	/* EEPROM address of the cached volume parameters */
+
 /*---------------------------------------*/
 /* Prototypes for disk control functions */
 
 DSTATUS disk_initialize (void);
 DRESULT disk_readp (BYTE*, DWORD, UINT, UINT);
+DRESULT disk_readm (BYTE*, DWORD, UINT);
+DRESULT disk_writep (const BYTE*, DWORD);
+DRESULT disk_writem (const BYTE*, DWORD, UINT);
+void disk_set_sink (DISK_SINK);
+void disk_set_block_sink (DISK_BLOCK_SINK);
+void disk_set_idle (DISK_IDLE);
+DRESULT disk_read_cid (BYTE*);
+void disk_cache_load (void*, UINT);
+void disk_cache_store (const void*, UINT);
 
 #define _DISKIO
 #endif
@@ -0,0 +1,260 @@
+/*
+ * flash.c
+ *
+ * Created: 10/19/2026
+ *
+ * Pipelined self programming of the application section .
+ *
+ * The page buffer is filled BEFORE the page erase (allowed by the data sheet) ,
+ * so the caller's SRAM buffer is released as soon as a page starts and erase
+ * plus write (~8 ms per page) overlap with whatever the caller does next .
+ *
+ * Interrupts stay disabled from the page fill until the RWW section is
+ * re-enabled after the write : the vector table lives in the RWW section and
+ * SPM instructions must follow the SPMCSR write within 4 cycles . After
+ * flash_boot_vectors(1) the vectors are in the boot section , then only each
+ * page buffer word and each SPM instruction run with interrupts disabled , a
+ * few cycles at a time (ISRs must not read the application section) .
+ *
+ * Pages whose content already matches flash are skipped , re-flashing the
+ * same or a slightly patched image only erases the pages that changed .
+ */
+
+#include <avr/io.h>
+#include <avr/boot.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+
+#include "flash.h"
+#include "trace.h"
+
+#define FLASH_IDLE     0
+#define FLASH_ERASING  1
+#define FLASH_WRITING  2
+
+#if (FLASHEND > 0xFFFFUL)
+   #define flash_read_byte(ADD)  pgm_read_byte_far(ADD)
+#else
+   #define flash_read_byte(ADD)  pgm_read_byte((uint16_t)(ADD))
+#endif
+
+#ifdef GICR
+   #define IVREG   GICR    // ATmega32
+#else
+   #define IVREG   MCUCR
+#endif
+
+typedef struct
+{
+	uint32_t page ;
+	const uint8_t *buf ;
+}FLASH_JOB ;
+
+#define FLASH_NO_PAGE  0xFFFFFFFFUL
+#define FLASH_PAGES    ( (FLASHEND + 1UL) / SPM_PAGESIZE )
+
+static FLASH_JOB queue[FLASH_QUEUE_SIZE] ;
+static uint8_t q_head , q_count ;
+static uint8_t state = FLASH_IDLE ;
+static uint8_t saved_sreg ;
+static uint8_t boot_vectors ;
+static uint32_t active_page ;
+static uint16_t pages_written , pages_skipped ;
+
+// Page assembler used by flash_write() .
+static uint8_t page_buff[2][SPM_PAGESIZE] ;
+static uint8_t page_index ;
+static uint32_t page_base = FLASH_NO_PAGE ;
+static uint8_t page_map[FLASH_PAGES / 8] ;   // Pages already queued by flash_write() since reset .
+
+static uint8_t flash_page_equal( uint32_t page , const uint8_t *buf )
+{
+	// Compare with current flash content , RWW section must be readable .
+	for( uint16_t i = 0 ; i<SPM_PAGESIZE ; i++ )
+	{
+		if(flash_read_byte(page + i) != buf[i])
+		   return 0 ;
+	}
+	return 1 ;
+}
+
+static void flash_start(void)
+{
+	// Load the oldest queued page into the SPM buffer and start erasing its flash page .
+	FLASH_JOB *job = &queue[q_head] ;
+	const uint8_t *buf = job->buf ;
+
+	q_head = (q_head + 1) & (FLASH_QUEUE_SIZE - 1) ;
+	q_count-- ;
+
+	if(flash_page_equal(job->page , buf))
+	{
+		pages_skipped++ ;
+		return ;
+	}
+
+	saved_sreg = SREG ;
+	for( uint16_t i = 0 ; i<SPM_PAGESIZE ; i+=2 , buf += 2)
+	{
+		// Set up little-endian word.
+		uint16_t w = buf[0] | (uint16_t)buf[1] << 8 ;
+		cli() ;
+		boot_page_fill(job->page + i , w) ;
+		if(boot_vectors)
+		   SREG = saved_sreg ;   // A received byte is served between two words .
+	}
+	cli() ;
+	boot_page_erase(job->page) ;
+	if(boot_vectors)
+	   SREG = saved_sreg ;
+	TRACE(TRACE_FLASH_ERASE , job->page / SPM_PAGESIZE) ;
+
+	active_page = job->page ;
+	state = FLASH_ERASING ;
+}
+
+void flash_poll(void)
+{
+	// Never blocks : advance one step if the previous SPM operation has finished .
+	if(boot_spm_busy())
+	   return ;
+
+	switch(state)
+	{
+		case FLASH_ERASING :
+			cli() ;
+			boot_page_write(active_page) ;
+			if(boot_vectors)
+			   SREG = saved_sreg ;
+			state = FLASH_WRITING ;
+			break ;
+
+		case FLASH_WRITING :
+			// Reenable RWW-section again , for the next compare and for the application .
+			cli() ;
+			boot_rww_enable() ;
+			SREG = saved_sreg ;
+			TRACE(TRACE_FLASH_DONE , active_page / SPM_PAGESIZE) ;
+			pages_written++ ;
+			state = FLASH_IDLE ;
+			// fall through
+
+		default :
+			// SPM must not start while the EEPROM is being written .
+			while(state == FLASH_IDLE && q_count && eeprom_is_ready())
+			   flash_start() ;
+			break ;
+	}
+}
+
+void flash_queue( uint32_t page , const uint8_t *buf )
+{
+	// buf must stay untouched until the page leaves the queue .
+	while(q_count == FLASH_QUEUE_SIZE)
+	   flash_poll() ;
+
+	queue[(q_head + q_count) & (FLASH_QUEUE_SIZE - 1)].page = page ;
+	queue[(q_head + q_count) & (FLASH_QUEUE_SIZE - 1)].buf = buf ;
+	q_count++ ;
+
+	flash_poll() ;
+}
+
+uint8_t flash_queued(void)
+{
+	return q_count ;
+}
+
+static void flash_end_page(void)
+{
+	// Queue the page being assembled .
+	if(page_base == FLASH_NO_PAGE)
+	   return ;
+	flash_queue(page_base , page_buff[page_index]) ;
+	page_map[(page_base / SPM_PAGESIZE) / 8] |= 1 << ((page_base / SPM_PAGESIZE) % 8) ;
+	page_base = FLASH_NO_PAGE ;
+}
+
+static void flash_begin_page( uint32_t page )
+{
+	// Switch to the other buffer , it is free once at most one page (the one just ended) is queued .
+	uint8_t *buf ;
+
+	flash_end_page() ;
+	page_index ^= 1 ;
+	buf = page_buff[page_index] ;
+	while(q_count > 1)
+	   flash_poll() ;
+
+	if(page_map[(page / SPM_PAGESIZE) / 8] & (1 << ((page / SPM_PAGESIZE) % 8)))
+	{
+		// Revisited page : keep the bytes written before .
+		flash_flush() ;
+		for( uint16_t i = 0 ; i<SPM_PAGESIZE ; i++ )
+		   buf[i] = flash_read_byte(page + i) ;
+	}
+	else
+	{
+		for( uint16_t i = 0 ; i<SPM_PAGESIZE ; i++ )
+		   buf[i] = 0xFF ;   // Bytes not given by the image stay erased .
+	}
+	page_base = page ;
+}
+
+void flash_write( uint32_t addr , const uint8_t *data , uint16_t count )
+{
+	// Write bytes at any address , full pages are queued when the address leaves them .
+	while(count--)
+	{
+		uint32_t page = addr & ~(uint32_t)(SPM_PAGESIZE - 1) ;
+
+		if(page != page_base)
+		   flash_begin_page(page) ;
+		page_buff[page_index][addr & (SPM_PAGESIZE - 1)] = *data++ ;
+		addr++ ;
+	}
+}
+
+void flash_read( uint32_t addr , uint8_t *buf , uint16_t count )
+{
+	// Read current flash content , waits until no SPM operation keeps the RWW section busy .
+	// The page flash_write() is assembling is not queued , its flash content is still the old one .
+	while(q_count || state != FLASH_IDLE)
+	   flash_poll() ;
+
+	while(count--)
+	   *buf++ = flash_read_byte(addr++) ;
+}
+
+void flash_flush(void)
+{
+	// Queue the page flash_write() is assembling , then wait until every queued page
+	// is programmed (or found unchanged) .
+	flash_end_page() ;
+	while(q_count || state != FLASH_IDLE)
+	   flash_poll() ;
+}
+
+void flash_boot_vectors( uint8_t enable )
+{
+	// Move the interrupt vectors to the start of the boot section , or back to address 0
+	// before the application starts . IVSEL must follow the IVCE write within 4 cycles .
+	uint8_t sreg = SREG , iv = IVREG & ~((1<<IVCE) | (1<<IVSEL)) ;
+
+	cli() ;
+	IVREG = iv | (1<<IVCE) ;
+	IVREG = enable ? (iv | (1<<IVSEL)) : iv ;
+	boot_vectors = enable ;
+	SREG = sreg ;
+}
+
+uint16_t flash_pages_written(void)
+{
+	return pages_written ;
+}
+
+uint16_t flash_pages_skipped(void)
+{
+	return pages_skipped ;
+}
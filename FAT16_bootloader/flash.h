@@ -0,0 +1,54 @@
+/*
+ * flash.h
+ *
+ * Created: 10/19/2026
+ *
+ * Pipelined self programming of the application section .
+ *
+ * Pages are queued with flash_queue() and programmed in the background :
+ * each page is copied into the SPM page buffer , then erased and written
+ * without waiting . flash_poll() moves the pipeline forward and is meant to
+ * run while the next data is read from the SD card , so total time is about
+ * max(SD time , SPM time) instead of their sum .
+ *
+ * The caller's buffer is free again once its page has left the queue
+ * (flash_queued() dropped below its position) .
+ *
+ * Pages identical to the current flash content are not erased nor written ,
+ * see flash_pages_written() / flash_pages_skipped() .
+ *
+ * flash_write() takes bytes at any address instead (e.g. from a HEX file) and
+ * assembles them into pages in two internal buffers . Bytes of a page the
+ * image does not give are left erased (0xFF) , unless the page was already
+ * written before , then its flash content is kept .
+ *
+ * Interrupts are held off while a page is programmed , unless the vectors
+ * were moved to the boot section with flash_boot_vectors(1) .
+ */
+
+
+#ifndef FLASH_H_
+#define FLASH_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+/*========== Constants ==========================*/
+
+#define FLASH_QUEUE_SIZE (1024 / SPM_PAGESIZE)   // Pages waiting for the SPM page buffer : two SD sectors , a power of 2 .
+
+/*========== Functions prototypes ==========================*/
+
+void flash_queue( uint32_t page , const uint8_t *buf ) ;
+void flash_write( uint32_t addr , const uint8_t *data , uint16_t count ) ;
+void flash_read( uint32_t addr , uint8_t *buf , uint16_t count ) ;
+void flash_poll(void) ;
+uint8_t flash_queued(void) ;
+void flash_flush(void) ;
+void flash_boot_vectors( uint8_t enable ) ;
+uint16_t flash_pages_written(void) ;
+uint16_t flash_pages_skipped(void) ;
+
+
+
+#endif /* FLASH_H_ */
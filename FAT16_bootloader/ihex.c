@@ -0,0 +1,146 @@
+/*
+ * ihex.c
+ *
+ * Created: 10/19/2026
+ *
+ * Streaming Intel HEX parser . One record is kept in SRAM until its
+ * checksum has been checked , so a corrupted line never reaches the flash .
+ *
+ *  :LLAAAATT<data>CC   LL = data length , AAAA = address , TT = type , CC = checksum
+ */
+
+#include "ihex.h"
+
+#define IHEX_TYPE_DATA          0x00
+#define IHEX_TYPE_EOF           0x01
+#define IHEX_TYPE_EXT_SEGMENT   0x02
+#define IHEX_TYPE_START_SEGMENT 0x03
+#define IHEX_TYPE_EXT_LINEAR    0x04
+#define IHEX_TYPE_START_LINEAR  0x05
+
+#define IHEX_REC_LENGTH   0
+#define IHEX_REC_ADDRESS  1   // 2 bytes , big-endian
+#define IHEX_REC_TYPE     3
+#define IHEX_REC_DATA     4
+#define IHEX_REC_EXTRA    5   // length + address + type + checksum
+
+static uint8_t record[IHEX_MAX_DATA + IHEX_REC_EXTRA] ;
+static uint16_t rec_count ;
+static uint8_t in_record , high_nibble ;
+static uint8_t status ;
+static uint32_t base , limit_addr ;
+static IHEX_OUT output ;
+
+static int8_t hex_value( uint8_t c )
+{
+	if(c >= '0' && c <= '9') return c - '0' ;
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10 ;
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10 ;
+	return -1 ;
+}
+
+static void ihex_record(void)
+{
+	// Whole record received , check it and act on its type .
+	uint8_t sum = 0 , len = record[IHEX_REC_LENGTH] ;
+	uint16_t value ;
+
+	for( uint16_t i = 0 ; i<rec_count ; i++ )
+	   sum += record[i] ;
+	if(sum)
+	{
+		status = IHEX_BAD_CHECKSUM ;
+		return ;
+	}
+
+	value = (uint16_t)record[IHEX_REC_DATA] << 8 | record[IHEX_REC_DATA+1] ;
+
+	switch(record[IHEX_REC_TYPE])
+	{
+		case IHEX_TYPE_DATA :
+		{
+			uint32_t addr = base + ((uint16_t)record[IHEX_REC_ADDRESS] << 8 | record[IHEX_REC_ADDRESS+1]) ;
+			if(addr + len > limit_addr)
+			{
+				status = IHEX_BAD_ADDRESS ;
+				return ;
+			}
+			if(len)
+			   output(addr , record + IHEX_REC_DATA , len) ;
+		}break ;
+
+		case IHEX_TYPE_EOF :
+			status = IHEX_DONE ;
+			break ;
+
+		case IHEX_TYPE_EXT_SEGMENT :
+			if(len != 2) status = IHEX_BAD_RECORD ;
+			base = (uint32_t)value << 4 ;
+			break ;
+
+		case IHEX_TYPE_EXT_LINEAR :
+			if(len != 2) status = IHEX_BAD_RECORD ;
+			base = (uint32_t)value << 16 ;
+			break ;
+
+		case IHEX_TYPE_START_SEGMENT :
+		case IHEX_TYPE_START_LINEAR :
+			break ;   // Entry point , the application always starts at its reset vector .
+
+		default :
+			status = IHEX_BAD_RECORD ;
+			break ;
+	}
+}
+
+void ihex_init( IHEX_OUT out , uint32_t limit )
+{
+	output = out ;
+	limit_addr = limit ;
+	base = 0 ;
+	in_record = 0 ;
+	status = IHEX_BUSY ;
+}
+
+void ihex_feed( const uint8_t *text , uint16_t count )
+{
+	while(count-- && status == IHEX_BUSY)
+	{
+		uint8_t c = *text++ ;
+		int8_t v ;
+
+		if(c == ':')
+		{
+			in_record = 1 ;
+			high_nibble = 1 ;
+			rec_count = 0 ;
+			continue ;
+		}
+		if(!in_record)
+		   continue ;   // Line ends and anything between records .
+
+		v = hex_value(c) ;
+		if(v < 0)
+		{
+			status = IHEX_BAD_RECORD ;   // Line ended before the record was complete .
+			return ;
+		}
+
+		if(high_nibble)
+		   record[rec_count] = v << 4 ;
+		else
+		   record[rec_count++] |= v ;
+		high_nibble ^= 1 ;
+
+		if(rec_count && high_nibble && rec_count == record[IHEX_REC_LENGTH] + IHEX_REC_EXTRA)
+		{
+			in_record = 0 ;
+			ihex_record() ;
+		}
+	}
+}
+
+uint8_t ihex_status(void)
+{
+	return status ;
+}
@@ -0,0 +1,40 @@
+/*
+ * ihex.h
+ *
+ * Created: 10/19/2026
+ *
+ * Streaming Intel HEX parser . Text is pushed in any chunk size , every
+ * data record whose checksum is correct is handed to an output callback
+ * with its absolute address (extended segment / linear address records are
+ * applied) . Records may come in any order and leave gaps .
+ */
+
+
+#ifndef IHEX_H_
+#define IHEX_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define IHEX_MAX_DATA       255   // Longest data field a record can carry .
+
+// ihex_status() values
+#define IHEX_BUSY           0   // More input needed
+#define IHEX_DONE           1   // End of file record seen , further input is ignored
+#define IHEX_BAD_CHECKSUM   2
+#define IHEX_BAD_RECORD     3   // Unknown record type or broken line
+#define IHEX_BAD_ADDRESS    4   // Data at or above the limit given to ihex_init()
+
+/*========== Types ==========================*/
+
+typedef void (*IHEX_OUT)(uint32_t addr , const uint8_t *data , uint8_t count) ;
+
+/*========== Functions prototypes ==========================*/
+
+void ihex_init( IHEX_OUT out , uint32_t limit ) ;
+void ihex_feed( const uint8_t *text , uint16_t count ) ;
+uint8_t ihex_status(void) ;
+
+
+#endif /* IHEX_H_ */
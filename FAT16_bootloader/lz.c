@@ -0,0 +1,138 @@
+/*
+ * lz.c
+ *
+ * Created: 10/19/2026
+ *
+ * Streaming decoder for compressed application images (see lzfmt.h) .
+ * The whole state is the 256 byte history window plus a few bytes , the
+ * window index is a uint8_t so it wraps around by itself .
+ */
+
+#include "lz.h"
+
+#define LZ_ST_HEADER   0
+#define LZ_ST_FLAGS    1
+#define LZ_ST_ITEM     2
+#define LZ_ST_LENGTH   3
+#define LZ_ST_END      4
+
+static uint8_t window[LZ_WINDOW_SIZE] ;
+static uint8_t win_pos ;
+static uint8_t header[LZ_HDR_SIZE] , header_count ;
+static uint8_t flags , flags_left ;
+static uint8_t distance ;
+static uint8_t state , status ;
+static uint32_t length , remaining ;
+static LZ_OUT output ;
+
+static void lz_emit( uint8_t data )
+{
+	window[win_pos++] = data ;
+	output(data) ;
+	if(--remaining == 0)
+	{
+		state = LZ_ST_END ;
+		status = LZ_DONE ;
+	}
+}
+
+static void lz_next_item(void)
+{
+	if(state == LZ_ST_END)
+	   return ;
+	flags >>= 1 ;
+	state = (--flags_left) ? LZ_ST_ITEM : LZ_ST_FLAGS ;
+}
+
+static void lz_header_done(void)
+{
+	uint32_t magic = header[LZ_HDR_MAGIC] | (uint32_t)header[LZ_HDR_MAGIC+1] << 8 |
+	                 (uint32_t)header[LZ_HDR_MAGIC+2] << 16 | (uint32_t)header[LZ_HDR_MAGIC+3] << 24 ;
+
+	length = header[LZ_HDR_LENGTH] | (uint32_t)header[LZ_HDR_LENGTH+1] << 8 |
+	         (uint32_t)header[LZ_HDR_LENGTH+2] << 16 | (uint32_t)header[LZ_HDR_LENGTH+3] << 24 ;
+	remaining = length ;
+
+	if(magic != LZ_MAGIC)
+	{
+		state = LZ_ST_END ;
+		status = LZ_BAD_MAGIC ;
+	}
+	else if(!length)
+	{
+		state = LZ_ST_END ;
+		status = LZ_DONE ;
+	}
+	else
+	   state = LZ_ST_FLAGS ;
+}
+
+void lz_init( LZ_OUT out )
+{
+	output = out ;
+	win_pos = 0 ;
+	header_count = 0 ;
+	length = remaining = 0 ;
+	state = LZ_ST_HEADER ;
+	status = LZ_BUSY ;
+}
+
+void lz_feed( const uint8_t *data , uint16_t count )
+{
+	while(count--)
+	{
+		uint8_t b = *data++ ;
+
+		switch(state)
+		{
+			case LZ_ST_HEADER :
+				header[header_count++] = b ;
+				if(header_count == LZ_HDR_SIZE)
+				   lz_header_done() ;
+				break ;
+
+			case LZ_ST_FLAGS :
+				flags = b ;
+				flags_left = 8 ;
+				state = LZ_ST_ITEM ;
+				break ;
+
+			case LZ_ST_ITEM :
+				if(flags & 1)
+				{
+					lz_emit(b) ;          // literal
+					lz_next_item() ;
+				}
+				else
+				{
+					distance = b ;        // match , length byte follows
+					state = LZ_ST_LENGTH ;
+				}
+				break ;
+
+			case LZ_ST_LENGTH :
+			{
+				uint16_t len = b + LZ_MIN_MATCH ;
+				uint8_t src = win_pos - distance - 1 ;
+
+				state = LZ_ST_ITEM ;
+				while(len-- && state != LZ_ST_END)
+				   lz_emit(window[src++]) ;
+				lz_next_item() ;
+			}break ;
+
+			default :
+				return ;   // done or error , ignore trailing bytes
+		}
+	}
+}
+
+uint8_t lz_status(void)
+{
+	return status ;
+}
+
+uint32_t lz_length(void)
+{
+	return length ;
+}
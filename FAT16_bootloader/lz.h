@@ -0,0 +1,39 @@
+/*
+ * lz.h
+ *
+ * Created: 10/19/2026
+ *
+ * Streaming decoder for compressed application images (see lzfmt.h) .
+ * Compressed bytes are pushed in any chunk size , decoded bytes are handed
+ * to an output callback one by one , so an image is decompressed while it
+ * is read from the card without ever being stored whole in SRAM .
+ */
+
+
+#ifndef LZ_H_
+#define LZ_H_
+
+#include <stdint.h>
+
+#include "lzfmt.h"
+
+/*========== Constants ==========================*/
+
+// lz_status() values
+#define LZ_BUSY        0   // More input needed
+#define LZ_DONE        1   // Whole image decoded , further input is ignored
+#define LZ_BAD_MAGIC   2   // Not a compressed image
+
+/*========== Types ==========================*/
+
+typedef void (*LZ_OUT)(uint8_t) ;   // Receives one decoded byte
+
+/*========== Functions prototypes ==========================*/
+
+void lz_init( LZ_OUT out ) ;
+void lz_feed( const uint8_t *data , uint16_t count ) ;
+uint8_t lz_status(void) ;
+uint32_t lz_length(void) ;
+
+
+#endif /* LZ_H_ */
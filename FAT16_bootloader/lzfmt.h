@@ -0,0 +1,39 @@
+/*
+ * lzfmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * Compressed application image format . Shared by lz.c and tools/mklz.c .
+ *
+ *  header  : magic (4 bytes) , uncompressed length (4 bytes)
+ *  stream  : groups of one flag byte followed by 8 items , flag bit 0 first
+ *            bit = 1 : literal , 1 byte copied to the output
+ *            bit = 0 : match , 2 bytes [distance-1 , length-LZ_MIN_MATCH] ,
+ *                      copies length bytes starting distance bytes back
+ *
+ * The window is LZ_WINDOW_SIZE bytes so the decoder only keeps that much
+ * history in SRAM . The stream ends when the uncompressed length is reached .
+ *
+ * All multi-byte fields are little-endian .
+ */
+
+
+#ifndef LZFMT_H_
+#define LZFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define LZ_MAGIC                0x315A4C47UL   // "GLZ1"
+#define LZ_WINDOW_SIZE          256            // Max match distance , do not change (8 bit distances)
+#define LZ_MIN_MATCH            3
+#define LZ_MAX_MATCH            ( LZ_MIN_MATCH + 255 )
+
+// Header byte offsets
+#define LZ_HDR_MAGIC            0    // 4 bytes
+#define LZ_HDR_LENGTH           4    // 4 bytes , uncompressed length
+#define LZ_HDR_SIZE             8
+
+
+#endif /* LZFMT_H_ */
@@ -16,7 +16,13 @@
    to start burn boot loader hex file in boot section in flash memory you should do that :
    1- open project -> properties ->Toolchain->AVR/GNU c linker -> miscellaneous 
    2- In other linker flags paste this line: "-Wl,--section-start=.text=0xE000" without quotes "" .
+   0xE000 is the ATmega644P boot section , see mcu.h for ATmega32 / ATmega1284P .
    
+ NOTE 3 :
+   Applications can program flash through bootsvc.h (bootsvc.c is part of this project) .
+   Add to the other linker flags of NOTE 2 : "-Wl,--section-start=.bootsvc=0xFFE0 -Wl,--undefined=bootsvc_table" .
+   The application includes bootsvc.h only , it must not link bootsvc.c .
+
  */ 
 
 #define F_CPU 8000000UL
@@ -33,16 +39,34 @@
 #include "pff.h"
 #include "diskio.h"
 #include "uart.h"
+#include "flash.h"
+#include "lz.h"
+#include "image.h"
+#include "ihex.h"
+#include "crc.h"
+#include "delta.h"
+#include "catalog.h"
+#include "prof.h"
+#include "mcu.h"
 
 #define ENABLED   1
 #define DISABLED  2
 #define DEBUG_MODE ENABLED
 #define APPLICATION_FLASH_ADD   0x0000  // To-do : we can get it from hex file 
-#define SPM_PAGESIZE 128
+#define BOOT_SECTION_ADD        MCU_BOOT_START  // Same as .text section start (NOTE 2) , nothing is written from here on .
 #define  MAX_FILES 10
 #define  MAX_FILE_NAME 13
 #define  DIR_NAME "files"
 #define  DIR_PATH "files/"
+#define  CATALOG_PATH "catalog.dat"  // Built by tools/mkcatalog , listed instead of reading the directory .
+#define  MENU_LINES 15  // Games listed from the catalog , header + 15 records = 2 sectors .
+#define  LOAD_RAW 0   // File content is the flash image
+#define  LOAD_LZ  1   // Compressed with tools/mklz
+#define  LOAD_HEX 2   // Intel HEX text
+#define  LOAD_DELTA 3 // Patch against the flashed image , from tools/mkdelta
+#define  DEBUG_BAUD 9600
+
+UART_BAUD_CHECK(DEBUG_BAUD) ;
 
 char buffer_out[101]={} ;
 
@@ -56,11 +80,26 @@ typedef struct
 #define debug(ASSERTION,EN,... ) {\
 	if(ASSERTION){ \
 		if(EN) Uart_Transimit_String(__VA_ARGS__) ; \
+		profile_end() ; \
 		return 0 ; }}
 /*================================= Function definitions =============================*/	
 	
-void boot_program_page (uint32_t page, uint8_t *buf) ;
 int choose_file_num() ;
+static void page_put(uint8_t data) ;
+static void raw_sink(const BYTE *data , UINT count) ;
+static void lz_sink(const BYTE *data , UINT count) ;
+static void hex_sink(const BYTE *data , UINT count) ;
+static void hex_out(uint32_t addr , const uint8_t *data , uint8_t count) ;
+static void delta_sink(const BYTE *data , UINT count) ;
+static void show_game(WORD num , const CAT_ENTRY *game) ;
+static void profile_end(void) ;
+
+/*================================= Loader state =============================*/		
+
+static uint32_t page_addr = APPLICATION_FLASH_ADD ;  // Next address for raw / decoded bytes .
+static uint32_t page_end = BOOT_SECTION_ADD ;  // Bytes at or above this address are dropped .
+static uint32_t hex_left = 0xFFFFFFFFUL ;  // HEX text bytes still belonging to the image .
+static uint32_t hex_crc = CRC32_INIT ;
 
 /*================================= Main Function =============================*/		
 
@@ -72,15 +111,27 @@ int main(void)
 	DIR dir_files ;
 	FRESULT rc ;
 	FILINFO fno;
+	CATALOG catalog ;
+	CAT_ENTRY game ;
+	uint8_t from_catalog ;
 	
     FILES_INFO content ;
     memset(&content , 0 , sizeof(content)) ; // clear that struct .
 	int i = 0 ;	
-	Uart_init(9600,0) ;  // for debug .
+	Uart_init(DEBUG_BAUD,0) ;  // for debug .
+	prof_start() ;
 	// mount sd card .
 	pf_mount(&fs) ; 
+	prof_mark(PROF_MOUNT) ;
+	// catalog : look up CATALOG.DAT and read its header , then a menu page costs one or two sector reads . Without it read "files" directory entry by entry .
+	from_catalog = (ct_open(&catalog , CATALOG_PATH) == FR_OK) ;
+	if(from_catalog)
+	{
+		Uart_Transimit_String("GAMES :\n\n") ;
+		ct_list(&catalog , 0 , MENU_LINES , show_game) ;
+	}
 	// open directory it's name is "files" .
-   if(pf_opendir(&dir_files , DIR_NAME) == FR_OK) 
+   else if(pf_opendir(&dir_files , DIR_NAME) == FR_OK) 
  {			
 		   
 	for(;;) 
@@ -101,7 +152,8 @@ int main(void)
  
  // Display bin directory to choose bin file from it .
  
- Uart_Transimit_String("FILES :\n\n") ;
+ if(!from_catalog)
+    Uart_Transimit_String("FILES :\n\n") ;
 	   for(int j = 0 ; j<i ; j++)
 	    {
 		  //sprintf(buffer_out,"%d- %d %s\n " , j+1 , content.file_size[j] , content.file_name[j] ) ;	
@@ -109,26 +161,132 @@ int main(void)
 		  Uart_Transimit_String("\n") ; 
 		}	
 
-UINT rb = SPM_PAGESIZE ; 
-uint8_t app_bin_buff[128] ;
+WORD rb = SECTOR_SIZE ; 
+uint8_t header[IMG_HDR_SIZE] ;
+uint8_t load_mode , hdr_status ;
+IMAGE_INFO image ;
+DELTA_INFO delta ;
 char file_path[26] = DIR_PATH  ;
 	
 int file_num  = choose_file_num() ; 
-strcat(file_path , content.file_name[file_num]) ;  // to be like that for example "files/app.bin" .
-//open target bin file .
-if(pf_open(file_path) == FR_OK) 
+if(from_catalog)
+{
+	// open game by its recorded cluster , a catalog older than the card content falls back to its file name .
+	game.name[0] = '\0' ;
+	rc = ct_read(&catalog , file_num , &game) ;
+	if(rc == FR_OK)
+	   rc = ct_open_game(&game , &fs.file) ;
+	if(rc == FR_NO_FILE && game.name[0])
+	{
+		Uart_Transimit_String("\nCatalog is out of date") ;
+		strcat(file_path , game.name) ;
+		rc = pf_open(file_path) ;
+	}
+}
+else
+{
+	strcat(file_path , content.file_name[file_num]) ;  // to be like that for example "files/app.bin" .
+	//open target bin file .
+	rc = pf_open(file_path) ;
+}
+if(rc == FR_OK) 
 
  {
+	 prof_mark(PROF_LOCATE) ;
 	 
-  while(rb== SPM_PAGESIZE) // read while until reach rb != SPM_PAGESIZE (end of file) .
+  // Images from tools/mkimage start with a header sector , compressed images (tools/mklz) with LZ_MAGIC ,
+  // Intel HEX files with ':' , patches (tools/mkdelta) with DELTA_MAGIC , anything else is a raw bin file .
+  pf_read(header , sizeof(header) , &rb) ;
+  hdr_status = (rb == sizeof(header)) ? image_parse_header(header , BOOT_SECTION_ADD , &image) : IMG_BAD_MAGIC ;
+  debug((hdr_status != IMG_OK && hdr_status != IMG_BAD_MAGIC) , DEBUG_MODE , "\nInvalid image header!!") ;
+  
+  if(hdr_status == IMG_OK)
+     load_mode = (image.flags & IMG_FLAG_IHEX) ? LOAD_HEX : LOAD_RAW ;
+  else if( rb >= 4 && ( header[0] | (uint32_t)header[1] << 8 | (uint32_t)header[2] << 16 | (uint32_t)header[3] << 24 ) == LZ_MAGIC )
+     load_mode = LOAD_LZ ;
+  else if( rb && header[0] == ':' )
+     load_mode = LOAD_HEX ;
+  else if( rb >= DELTA_HDR_SIZE && delta_parse_header(header , &delta) == 0 )
+     load_mode = LOAD_DELTA ;
+  else
+     load_mode = LOAD_RAW ;
+  
+  if(hdr_status == IMG_OK)
+  {
+	 // Same image as the last verified update : nothing to program .
+	 if(image_is_flashed(&image))
+	 {
+		Uart_Transimit_String("\nApplication is up to date") ;
+		profile_end() ;
+		( (void (*)(void)) APPLICATION_FLASH_ADD)() ;
+	 }
+	 page_addr = image.load ;
+	 page_end = image.load + (uint32_t)image.pages * SPM_PAGESIZE ;
+	 hex_left = image.length ;
+	 pf_lseek(IMG_SECTOR_SIZE) ;
+  }
+  else if(load_mode == LOAD_DELTA)
   {
-	 memset(app_bin_buff , 0xFF , SPM_PAGESIZE) ;  // This to prevent if it read less than 128 byte at the end of file ex . rb = 100 so it reads only 100 and the remaining 28 byte will be 0xFF to setat the end .
-	 pf_read(app_bin_buff , SPM_PAGESIZE , &rb) ;
-	 if(rb) boot_program_page(APPLICATION_FLASH_ADD + (i*SPM_PAGESIZE) , app_bin_buff) ; // write on flash page by page .
-  } // while
+	 // Patch must be made against what is in flash now , the result is described like an image .
+	 image.load = APPLICATION_FLASH_ADD ;
+	 image.length = delta.base_length ;
+	 debug((delta.base_length > BOOT_SECTION_ADD || image_flash_crc(&image) != delta.base_crc) , DEBUG_MODE ,"\nPatch does not match flashed image!!") ;
+	 image.length = delta.length ;
+	 image.crc = delta.crc ;
+	 pf_lseek(DELTA_HDR_SIZE) ;
+  }
+  else
+     pf_lseek(0) ;
+  
+  // Flash is about to change in every mode : an earlier image put back on the card must not look flashed .
+  image_forget() ;
+  prof_mark(PROF_HEADER) ;
+  
+  // File data is forwarded from the SD driver straight to the decoder / parser / page assembler .
+  lz_init(page_put) ;
+  ihex_init(hex_out , BOOT_SECTION_ADD) ;
+  delta_init(BOOT_SECTION_ADD) ;
+  disk_set_block_sink( (load_mode == LOAD_LZ) ? lz_sink : (load_mode == LOAD_HEX) ? hex_sink :
+                       (load_mode == LOAD_DELTA) ? delta_sink : raw_sink ) ;
+  disk_set_idle(flash_poll) ;  // previous page is erased/written while the next one is read .
+  do
+  {
+	 pf_read(0 , SECTOR_SIZE , &rb) ;
+  } while(rb == SECTOR_SIZE && !(load_mode == LOAD_LZ && lz_status() != LZ_BUSY)
+                             && !(load_mode == LOAD_DELTA && delta_status() != DELTA_BUSY)) ; // read while until end of file or end of image .
+  prof_mark(PROF_PROGRAM) ;
+  flash_flush() ;
+  prof_mark(PROF_FLUSH) ;
+  disk_set_idle(0) ;
+  disk_set_block_sink(0) ;
+  
+  debug((load_mode == LOAD_LZ && lz_status() != LZ_DONE) , DEBUG_MODE , "\nCompressed image is truncated!!") ;
+  debug((load_mode == LOAD_HEX && ihex_status() != IHEX_DONE) , DEBUG_MODE , "\nBad HEX file!!") ;
+  debug((load_mode == LOAD_DELTA && delta_status() != DELTA_DONE) , DEBUG_MODE , "\nBad patch file!!") ;
+  Uart_Transimit_String("\nPages written : ") ;
+  Uart_Print_Int(flash_pages_written()) ;
+  Uart_Transimit_String(" , unchanged : ") ;
+  Uart_Print_Int(flash_pages_skipped()) ;
+  
+  if(load_mode == LOAD_DELTA)
+  {
+	 debug((image_flash_crc(&image) != image.crc) , DEBUG_MODE ,"\nFlash verify failed!!");
+	 image_mark_flashed(&image) ;
+  }
+  else if(hdr_status == IMG_OK)
+  {
+	 // Read the programmed pages back (HEX : check the text) , remember the image only if they match its CRC .
+	 if(load_mode == LOAD_HEX)
+	    debug((CRC32_FINAL(hex_crc) != image.crc) , DEBUG_MODE ,"\nImage CRC mismatch!!")
+	 else
+	    debug((image_flash_crc(&image) != image.crc) , DEBUG_MODE ,"\nFlash verify failed!!");
+	 image_mark_flashed(&image) ;
+  }
+  prof_mark(PROF_VERIFY) ;
   
  }//if  
 	
+   profile_end() ;
    ( (void (*)(void)) APPLICATION_FLASH_ADD)() ;
 	
 	
@@ -136,36 +294,69 @@ if(pf_open(file_path) == FR_OK)
 }
 
 
-void boot_program_page (uint32_t page, uint8_t *buf)
+int choose_file_num()
 {
-	//I will use 24 page eache page contain 256 byte [128 word] .
-	
-	
-    uint16_t i;
-    uint8_t sreg;
-    // Disable interrupts.
-    sreg = SREG;
-    cli();
-    eeprom_busy_wait ();
-    boot_page_erase (page);
-    boot_spm_busy_wait ();      // Wait until the memory is erased.
-    for (i=0; i<SPM_PAGESIZE; i+=2 , buf += 2)
-    {
-        // Set up little-endian word.
-        uint16_t w = *( (uint16_t *) buf) ;
-    
-        boot_page_fill (page + i, w);
-    }
-    boot_page_write (page);     // Store buffer in flash page.
-    boot_spm_busy_wait();       // Wait until the memory is written.
-    // Reenable RWW-section again. We need this if we want to jump back
-    // to the application after bootloading.
-    boot_rww_enable ();
-    // Re-enable interrupts (if they were ever enabled).
-    SREG = sreg;
+	return 0 ;
 }
 
-int choose_file_num()
+static void page_put(uint8_t data)
 {
-	return 0 ;
+	// Raw / decoded bytes follow each other from page_addr , flash_write() queues full pages .
+	if(page_addr >= page_end)
+	   return ;  // past the image or into the boot section .
+	flash_write(page_addr++ , &data , 1) ;
+}
+
+static void raw_sink(const BYTE *data , UINT count)
+{
+	if(page_addr >= page_end)
+	   return ;
+	if(count > page_end - page_addr)
+	   count = page_end - page_addr ;
+	flash_write(page_addr , data , count) ;
+	page_addr += count ;
+}
+
+static void lz_sink(const BYTE *data , UINT count)
+{
+	lz_feed(data , count) ;
+}
+
+static void hex_sink(const BYTE *data , UINT count)
+{
+	// Padding after the text of a mkimage HEX image is neither parsed nor part of the CRC .
+	if(count > hex_left)
+	   count = hex_left ;
+	hex_left -= count ;
+	hex_crc = crc32_update(hex_crc , data , count) ;
+	ihex_feed(data , count) ;
+}
+
+static void hex_out(uint32_t addr , const uint8_t *data , uint8_t count)
+{
+	flash_write(addr , data , count) ;
+}
+
+static void delta_sink(const BYTE *data , UINT count)
+{
+	delta_feed(data , count) ;
+}
+
+static void show_game(WORD num , const CAT_ENTRY *game)
+{
+	Uart_Transimit_String((char*)game->title) ;
+	Uart_Transimit_String("\n") ;
+}
+static void profile_end(void)
+{
+	// Keep this boot's profile for the next boot / the application , Timer1 back to its reset state .
+	prof_count(PROF_CNT_WRITTEN , flash_pages_written()) ;
+	prof_count(PROF_CNT_SKIPPED , flash_pages_skipped()) ;
+	prof_stop() ;
+	#ifdef PROF_SAVE
+	prof_save() ;
+	#endif
+	#if ( DEBUG_MODE == ENABLED )
+	prof_report() ;
+	#endif
 }
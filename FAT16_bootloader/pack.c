@@ -0,0 +1,106 @@
+/*
+ * pack.c
+ *
+ * Created: 10/19/2026
+ *
+ * Game asset pack reader , see packfmt.h for the layout .
+ */ 
+
+#include "pack.h"
+#include "diskio.h"
+
+
+/*-----------------------------------------------------------------------*/
+/* Open a Pack                                                           */
+/*-----------------------------------------------------------------------*/
+
+FRESULT pk_open (
+	PACK *pk,			/* Pointer to the pack object to initialize */
+	const char *path	/* Pointer to the pack file name */
+)
+{
+	FRESULT res;
+	BYTE hdr[PACK_HDR_SIZE];
+
+
+	res = pf_open(path);
+	if (res != FR_OK) return res;
+	res = pf_contig(&pk->base, &pk->size);	/* Packs are read by sector, the file must not be fragmented */
+	if (res != FR_OK) return res;
+
+	if (disk_readp(hdr, pk->base, 0, PACK_HDR_SIZE)) return FR_DISK_ERR;
+	pk->slots = LD_WORD(hdr+PACK_HDR_SLOTS);
+	pk->count = LD_WORD(hdr+PACK_HDR_COUNT);
+	if (LD_DWORD(hdr+PACK_HDR_MAGIC) != PACK_MAGIC ||
+		LD_WORD(hdr+PACK_HDR_VERSION) != PACK_VERSION ||
+		pk->slots < PACK_MIN_SLOTS || (pk->slots & (pk->slots - 1)) ||
+		pk->count > pk->slots ||
+		pk->size < (DWORD)PACK_TOC_SECTOR * PACK_SECTOR_SIZE + (DWORD)pk->slots * PACK_ENTRY_SIZE)
+		return FR_NO_FILESYSTEM;			/* Truncated or corrupt pack */
+
+	return FR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Find an Asset                                                         */
+/*-----------------------------------------------------------------------*/
+/* The packer keeps the TOC at most half full, so the first probe almost
+/  always hits. Each probe is one 16 byte partial sector read. */
+
+FRESULT pk_find (
+	const PACK *pk,		/* Pointer to the open pack */
+	DWORD id,			/* Asset id, pack_hash() of the asset name */
+	ASSET *as			/* Pointer to store the asset location */
+)
+{
+	BYTE ent[PACK_ENTRY_SIZE];
+	WORD slot, n;
+	DWORD eid, sect;
+
+
+	slot = (WORD)id & (pk->slots - 1);
+	for (n = pk->slots; n; n--) {
+		if (disk_readp(ent, pk->base + PACK_TOC_SECTOR + slot / PACK_ENTRIES_PER_SECTOR,
+				(slot % PACK_ENTRIES_PER_SECTOR) * PACK_ENTRY_SIZE, PACK_ENTRY_SIZE))
+			return FR_DISK_ERR;
+		eid = LD_DWORD(ent+PACK_ENT_ID);
+		if (eid == id) {
+			sect = LD_DWORD(ent+PACK_ENT_SECTOR);
+			as->size = LD_DWORD(ent+PACK_ENT_LENGTH);
+			if (sect > pk->size / PACK_SECTOR_SIZE ||		/* Asset must end inside the pack file */
+				as->size > pk->size - sect * PACK_SECTOR_SIZE)
+				return FR_NO_FILESYSTEM;
+			as->sect = pk->base + sect;
+			as->nsect = (WORD)((as->size + PACK_SECTOR_SIZE - 1) / PACK_SECTOR_SIZE);
+			as->flags = ent[PACK_ENT_FLAGS];
+			return FR_OK;
+		}
+		if (!eid) break;				/* Empty slot ends the probe sequence */
+		slot = (slot + 1) & (pk->slots - 1);
+	}
+
+	return FR_NO_FILE;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read Asset Sectors                                                    */
+/*-----------------------------------------------------------------------*/
+
+FRESULT pk_read (
+	const ASSET *as,	/* Pointer to the asset location */
+	WORD first,			/* First sector to read, relative to the asset */
+	WORD count,			/* Number of sectors to read */
+	BYTE *buff			/* Pointer to the read buffer (NULL: forward to the stream) */
+)
+{
+	if (first >= as->nsect) return FR_OK;
+	if (count > as->nsect - first) count = as->nsect - first;
+
+	return disk_readm(buff, as->sect + first, count) ? FR_DISK_ERR : FR_OK;
+}
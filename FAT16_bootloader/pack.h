@@ -0,0 +1,41 @@
+/*
+ * pack.h
+ *
+ * Created: 10/19/2026
+ *
+ * Game asset pack reader . An asset id is resolved to a raw sector range
+ * once , then the asset is streamed with multiple block reads without
+ * touching the directory or the FAT again .
+ */ 
+
+
+#ifndef PACK_H_
+#define PACK_H_
+
+#include "pff.h"
+#include "packfmt.h"
+
+/*========== Data structures ==========================*/
+
+typedef struct {
+	DWORD	base;		/* First sector of the pack file (lba) */
+	WORD	slots;		/* Number of TOC slots (power of two) */
+	WORD	count;		/* Number of assets */
+	DWORD	size;		/* Pack file size in bytes */
+} PACK;
+
+typedef struct {
+	DWORD	sect;		/* First sector of the asset (lba) */
+	DWORD	size;		/* Asset size in bytes */
+	WORD	nsect;		/* Number of sectors occupied by the asset */
+	BYTE	flags;		/* PACK_FLAG_xxx */
+} ASSET;
+
+/*========== Functions prototypes ==========================*/
+
+FRESULT pk_open (PACK*, const char*);				/* Open a pack file stored contiguously */
+FRESULT pk_find (const PACK*, DWORD, ASSET*);		/* Resolve an asset id to its sector range */
+FRESULT pk_read (const ASSET*, WORD, WORD, BYTE*);	/* Read sectors of an asset (NULL: forward to the stream) */
+
+
+#endif /* PACK_H_ */
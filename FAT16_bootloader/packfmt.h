@@ -0,0 +1,65 @@
+/*
+ * packfmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * On-card layout of a game asset pack . Shared by pack.c and tools/mkpack.c .
+ *
+ *  sector 0         : header
+ *  sector 1..       : table of contents , open addressing hash table of
+ *                     16 byte entries keyed by asset id (id 0 = empty slot)
+ *  following        : asset data , every asset starts on a sector boundary
+ *
+ * All multi-byte fields are little-endian .
+ */ 
+
+
+#ifndef PACKFMT_H_
+#define PACKFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define PACK_MAGIC              0x4B415047UL   // "GPAK"
+#define PACK_VERSION            1
+#define PACK_SECTOR_SIZE        512
+#define PACK_TOC_SECTOR         1
+#define PACK_ENTRY_SIZE         16
+#define PACK_ENTRIES_PER_SECTOR ( PACK_SECTOR_SIZE / PACK_ENTRY_SIZE )
+#define PACK_MIN_SLOTS          PACK_ENTRIES_PER_SECTOR
+
+// Header byte offsets
+#define PACK_HDR_MAGIC          0    // 4 bytes
+#define PACK_HDR_VERSION        4    // 2 bytes
+#define PACK_HDR_SLOTS          6    // 2 bytes , number of TOC slots (power of two)
+#define PACK_HDR_COUNT          8    // 2 bytes , number of assets
+#define PACK_HDR_SIZE           10
+
+// TOC entry byte offsets
+#define PACK_ENT_ID             0    // 4 bytes , pack_hash() of the asset name
+#define PACK_ENT_SECTOR         4    // 4 bytes , first sector relative to the pack start
+#define PACK_ENT_LENGTH         8    // 4 bytes , length in bytes
+#define PACK_ENT_FLAGS          12   // 1 byte
+
+// TOC entry flags
+#define PACK_FLAG_COMPRESSED    0x01
+
+/*========== Functions ==========================*/
+
+// FNV-1a hash of an asset name , never returns 0 as it marks an empty slot .
+static inline uint32_t pack_hash(const char *name)
+{
+	uint32_t h = 2166136261UL ;
+	
+	while(*name)
+	{
+		h ^= (uint8_t)*name++ ;
+		h *= 16777619UL ;
+	}
+	
+	return h ? h : 1 ;
+}
+
+
+#endif /* PACKFMT_H_ */
@@ -32,6 +32,24 @@
 static
 FATFS *FatFs;	/* Pointer to the file system object (logical drive) */
 
+#if _USE_MOUNT_CACHE
+/* Volume parameters saved by pf_mount() so the next mount of the same
+/  card and volume can skip the MBR and boot record discovery. */
+typedef struct {
+	BYTE	cid[16];	/* Card identification register of the cached card */
+	DWORD	volid;		/* Volume serial number of the cached volume */
+	DWORD	bsect;		/* Boot record sector (lba) */
+	BYTE	fs_type;	/* FAT sub type */
+	BYTE	csize;		/* Number of sectors per cluster */
+	WORD	n_rootdir;	/* Number of root directory entries */
+	CLUST	max_clust;	/* Maximum cluster# + 1 */
+	DWORD	fatbase;	/* FAT start sector */
+	DWORD	dirbase;	/* Root directory start sector (Cluster# on FAT32) */
+	DWORD	database;	/* Data start sector */
+	WORD	sum;		/* Check sum of the members above */
+} MCACHE;
+#endif
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -122,6 +140,33 @@ DWORD clust2sect (	/* !=0: Sector number, 0: Failed - invalid cluster# */
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Get cluster# from the cluster run map of a file                       */
+/*-----------------------------------------------------------------------*/
+
+static
+CLUST clmt_clust (	/* !=0: Cluster number, 0: Offset is out of the map */
+	FIL *fp,		/* Pointer to the file object with a run map */
+	DWORD ofs		/* File offset to be converted to cluster# */
+)
+{
+	DWORD cl, ncl, *tbl;
+
+
+	tbl = fp->cltbl + 1;				/* Top of the run map */
+	cl = ofs / 512 / FatFs->csize;		/* Cluster index in the file */
+	for (;;) {
+		ncl = *tbl++;					/* Number of clusters in the run */
+		if (!ncl) return 0;				/* End of the map */
+		if (cl < ncl) break;			/* In this run? */
+		cl -= ncl; tbl++;				/* Next run */
+	}
+	return (CLUST)(cl + *tbl);
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Rewind directory index                           */
 /*-----------------------------------------------------------------------*/
@@ -440,6 +485,96 @@ BYTE check_fs (	/* 0:The FAT boot record, 1:Valid boot record but not an FAT, 2:
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Mount cache - Restore or save the volume parameters                   */
+/*-----------------------------------------------------------------------*/
+#if _USE_MOUNT_CACHE
+static
+WORD mcache_sum (	/* Check sum of a cache image */
+	const MCACHE *mc
+)
+{
+	const BYTE *p = (const BYTE*)mc;
+	WORD n = (WORD)((const BYTE*)&mc->sum - p), sum = 0x5AA5;
+
+	while (n--) sum = (WORD)((sum << 1) | (sum >> 15)) + *p++;
+	return sum;
+}
+
+
+static
+DWORD mcache_volid (	/* Volume serial number read from the boot record */
+	BYTE *buf,			/* Working buffer (4 bytes) */
+	DWORD bsect,		/* Boot record sector */
+	BYTE fmt			/* FAT sub type */
+)
+{
+	if (disk_readp(buf, bsect,
+#if _FS_FAT32
+			(fmt == FS_FAT32) ? BS_VolID32 :
+#endif
+			BS_VolID, 4))
+		return 0;
+	return LD_DWORD(buf);
+}
+
+
+static
+FRESULT mcache_restore (	/* FR_OK: fs is initialized from the cache */
+	FATFS *fs,				/* File system object to be initialized */
+	BYTE *buf				/* Working buffer (16 bytes at least) */
+)
+{
+	MCACHE mc;
+
+
+	disk_cache_load(&mc, sizeof(mc));
+	if (mc.sum != mcache_sum(&mc)) return FR_NO_FILESYSTEM;	/* Blank or corrupted cache */
+	if (disk_read_cid(buf) || mem_cmp(buf, mc.cid, 16))		/* Another card */
+		return FR_NO_FILESYSTEM;
+	if (mcache_volid(buf, mc.bsect, mc.fs_type) != mc.volid)	/* Volume has been reformatted */
+		return FR_NO_FILESYSTEM;
+
+	fs->fs_type = mc.fs_type;
+	fs->csize = mc.csize;
+	fs->n_rootdir = mc.n_rootdir;
+	fs->max_clust = mc.max_clust;
+	fs->fatbase = mc.fatbase;
+	fs->dirbase = mc.dirbase;
+	fs->database = mc.database;
+
+	return FR_OK;
+}
+
+
+static
+void mcache_save (
+	FATFS *fs,		/* Mounted file system object */
+	DWORD bsect		/* Boot record sector of the volume */
+)
+{
+	MCACHE mc;
+	BYTE buf[4];
+
+
+	if (disk_read_cid(mc.cid)) return;		/* Card cannot be identified, do not cache */
+	mc.volid = mcache_volid(buf, bsect, fs->fs_type);
+	mc.bsect = bsect;
+	mc.fs_type = fs->fs_type;
+	mc.csize = fs->csize;
+	mc.n_rootdir = fs->n_rootdir;
+	mc.max_clust = fs->max_clust;
+	mc.fatbase = fs->fatbase;
+	mc.dirbase = fs->dirbase;
+	mc.database = fs->database;
+	mc.sum = mcache_sum(&mc);
+	disk_cache_store(&mc, sizeof(mc));
+}
+#endif /* _USE_MOUNT_CACHE */
+
+
+
+
 /*--------------------------------------------------------------------------
 
    Public Functions
@@ -470,6 +605,14 @@ FRESULT pf_mount (
 	if(mount_status  == STA_NOINIT)
 	  return FR_NOT_READY;
 
+#if _USE_MOUNT_CACHE
+	if (mcache_restore(fs, buf) == FR_OK) {	/* Same card and volume as last mount */
+		fs->file.flag = 0;
+		FatFs = fs;
+		return FR_OK;
+	}
+#endif
+
 	/* Search FAT partition on the drive */
 	bsect = 0;
 	fmt = check_fs(buf, bsect);			/* Check sector 0 as an SFD format */
@@ -522,7 +665,11 @@ FRESULT pf_mount (
 		fs->dirbase = fs->fatbase + fsize;				/* Root directory start sector (lba) */
 	fs->database = fs->fatbase + fsize + fs->n_rootdir / 16;	/* Data start sector (lba) */
 
-	fs->flag = 0;
+#if _USE_MOUNT_CACHE
+	mcache_save(fs, bsect);
+#endif
+
+	fs->file.flag = 0;
 	FatFs = fs;
 
 	return FR_OK;
@@ -535,7 +682,8 @@ FRESULT pf_mount (
 /* Open or Create a File                                                 */
 /*-----------------------------------------------------------------------*/
 
-FRESULT pf_open (
+FRESULT pf_fopen (
+	FIL *fp,			/* Pointer to the blank file object */
 	const char *path	/* Pointer to the file name */
 )
 {
@@ -548,7 +696,7 @@ FRESULT pf_open (
 	if (!fs)						/* Check file system */
 		return FR_NOT_ENABLED;
 
-	fs->flag = 0;
+	fp->flag = 0;
 	fs->buf = dir;
 	dj.fn = sp;
 	res = follow_path(&dj, path);	/* Follow the file path */
@@ -556,19 +704,76 @@ FRESULT pf_open (
 	if (!dir[0] || (dir[DIR_Attr] & AM_DIR))	/* It is a directory */
 		return FR_NO_FILE;
 
-	fs->org_clust =						/* File start cluster */
+	fp->org_clust =						/* File start cluster */
 #if _FS_FAT32
 		((DWORD)LD_WORD(dir+DIR_FstClusHI) << 16) |
 #endif
 		LD_WORD(dir+DIR_FstClusLO);
-	fs->fsize = LD_DWORD(dir+DIR_FileSize);	/* File size */
-	fs->fptr = 0;						/* File pointer */
-	fs->flag = FA_OPENED;
+	fp->fsize = LD_DWORD(dir+DIR_FileSize);	/* File size */
+	fp->fptr = 0;						/* File pointer */
+	fp->cltbl = 0;						/* No run map, follow the FAT */
+	fp->flag = FA_OPENED;
+
+	return FR_OK;
+}
+
+
+/* Open a file by its start cluster, as recorded in a catalog built on the
+/  host. The directory is not searched, instead the cluster chain must hold
+/  exactly fsize bytes, a file freed or rewritten since gives FR_NO_FILE.
+/  This costs one FAT entry read per cluster, none of the file data. */
+
+FRESULT pf_fopen_clust (
+	FIL *fp,			/* Pointer to the blank file object */
+	CLUST sclust,		/* Start cluster of the file */
+	DWORD fsize			/* File size */
+)
+{
+	CLUST clst;
+	DWORD bcs, ofs;
+	FATFS *fs = FatFs;
+
+
+	if (!fs)						/* Check file system */
+		return FR_NOT_ENABLED;
+
+	fp->flag = 0;
+	if (fsize) {
+		if (sclust < 2 || sclust >= fs->max_clust)	/* Check start cluster range */
+			return FR_NO_FILE;
+		bcs = (DWORD)fs->csize * 512;	/* Cluster size (byte) */
+		clst = sclust;
+		for (ofs = bcs; ; ofs += bcs) {	/* Follow the chain over the file size */
+			clst = get_fat(clst);
+			if (clst == 1) return FR_DISK_ERR;
+			if (ofs >= fsize) break;
+			if (clst < 2 || clst >= fs->max_clust)	/* Chain shorter than the file */
+				return FR_NO_FILE;
+		}
+		if (clst >= 2 && clst < fs->max_clust)	/* Chain longer than the file */
+			return FR_NO_FILE;
+	}
+
+	fp->org_clust = sclust;				/* File start cluster */
+	fp->fsize = fsize;					/* File size */
+	fp->fptr = 0;						/* File pointer */
+	fp->cltbl = 0;						/* No run map, follow the FAT */
+	fp->flag = FA_OPENED;
 
 	return FR_OK;
 }
 
 
+FRESULT pf_open (
+	const char *path	/* Pointer to the file name */
+)
+{
+	if (!FatFs) return FR_NOT_ENABLED;	/* Check file system */
+
+	return pf_fopen(&FatFs->file, path);	/* Open the built-in file object */
+}
+
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -576,7 +781,8 @@ FRESULT pf_open (
 /*-----------------------------------------------------------------------*/
 #if _USE_READ
 
-FRESULT pf_read (
+FRESULT pf_fread (
+	FIL *fp,		/* Pointer to the file object */
 	void* buff,		/* Pointer to the read buffer (NULL:Forward data to the stream)*/
 	WORD btr,		/* Number of bytes to read */
 	WORD* br		/* Pointer to number of bytes read */
@@ -592,39 +798,54 @@ FRESULT pf_read (
 
 	*br = 0;
 	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
-	if (!(fs->flag & FA_OPENED))		/* Check if opened */
+	if (!(fp->flag & FA_OPENED))		/* Check if opened */
 		return FR_NOT_OPENED;
 
-	remain = fs->fsize - fs->fptr;
+	remain = fp->fsize - fp->fptr;
 	if (btr > remain) btr = (WORD)remain;			/* Truncate btr by remaining bytes */
 
 	while (btr)	{									/* Repeat until all data transferred */
-		if ((fs->fptr % 512) == 0) {				/* On the sector boundary? */
-			if ((fs->fptr / 512 % fs->csize) == 0) {	/* On the cluster boundary? */
-				clst = (fs->fptr == 0) ?			/* On the top of the file? */
-					fs->org_clust : get_fat(fs->curr_clust);
+		if ((fp->fptr % 512) == 0) {				/* On the sector boundary? */
+			if ((fp->fptr / 512 % fs->csize) == 0) {	/* On the cluster boundary? */
+				if (fp->fptr == 0)					/* On the top of the file? */
+					clst = fp->org_clust;
+				else								/* Next cluster from the run map or the FAT */
+					clst = fp->cltbl ? clmt_clust(fp, fp->fptr) : get_fat(fp->curr_clust);
 				if (clst <= 1) goto fr_abort;
-				fs->curr_clust = clst;				/* Update current cluster */
-				fs->csect = 0;						/* Reset sector offset in the cluster */
+				fp->curr_clust = clst;				/* Update current cluster */
+				fp->csect = 0;						/* Reset sector offset in the cluster */
 			}
-			sect = clust2sect(fs->curr_clust);		/* Get current sector */
+			sect = clust2sect(fp->curr_clust);		/* Get current sector */
 			if (!sect) goto fr_abort;
-			fs->dsect = sect + fs->csect++;
+			fp->dsect = sect + fp->csect++;
 		}
-		rcnt = 512 - ((WORD)fs->fptr % 512);		/* Get partial sector data from sector buffer */
+		rcnt = 512 - ((WORD)fp->fptr % 512);		/* Get partial sector data from sector buffer */
 		if (rcnt > btr) rcnt = btr;
-		dr = disk_readp(!buff ? 0 : rbuff, fs->dsect, (WORD)(fs->fptr % 512), rcnt);
+		dr = disk_readp(!buff ? 0 : rbuff, fp->dsect, (WORD)(fp->fptr % 512), rcnt);
 		if (dr) goto fr_abort;
-		fs->fptr += rcnt; rbuff += rcnt;			/* Update pointers and counters */
+		fp->fptr += rcnt; rbuff += rcnt;			/* Update pointers and counters */
 		btr -= rcnt; *br += rcnt;
 	}
 
 	return FR_OK;
 
 fr_abort:
-	fs->flag = 0;
+	fp->flag = 0;
 	return FR_DISK_ERR;
 }
+
+
+FRESULT pf_read (
+	void* buff,		/* Pointer to the read buffer (NULL:Forward data to the stream)*/
+	WORD btr,		/* Number of bytes to read */
+	WORD* br		/* Pointer to number of bytes read */
+)
+{
+	*br = 0;
+	if (!FatFs) return FR_NOT_ENABLED;	/* Check file system */
+
+	return pf_fread(&FatFs->file, buff, btr, br);
+}
 #endif
 
 
@@ -645,54 +866,131 @@ FRESULT pf_write (
 	const BYTE *p = buff;
 	WORD wcnt;
 	FATFS *fs = FatFs;
+	FIL *fp;
 
 
 	*bw = 0;
 	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
-	if (!(fs->flag & FA_OPENED))		/* Check if opened */
+	fp = &fs->file;
+	if (!(fp->flag & FA_OPENED))		/* Check if opened */
 		return FR_NOT_OPENED;
 
 	if (!btw) {		/* Finalize request */
-		if ((fs->flag & FA__WIP) && disk_writep(0, 0)) goto fw_abort;
-		fs->flag &= ~FA__WIP;
+		if ((fp->flag & FA__WIP) && disk_writep(0, 0)) goto fw_abort;
+		fp->flag &= ~FA__WIP;
 		return FR_OK;
 	} else {		/* Write data request */
-		if (!(fs->flag & FA__WIP))		/* Round down fptr to the sector boundary */
-			fs->fptr &= 0xFFFFFE00;
+		if (!(fp->flag & FA__WIP))		/* Round down fptr to the sector boundary */
+			fp->fptr &= 0xFFFFFE00;
 	}
-	remain = fs->fsize - fs->fptr;
+	remain = fp->fsize - fp->fptr;
 	if (btw > remain) btw = (WORD)remain;			/* Truncate btw by remaining bytes */
 
 	while (btw)	{									/* Repeat until all data transferred */
-		if (((WORD)fs->fptr % 512) == 0) {				/* On the sector boundary? */
-			if ((fs->fptr / 512 % fs->csize) == 0) {	/* On the cluster boundary? */
-				clst = (fs->fptr == 0) ?			/* On the top of the file? */
-					fs->org_clust : get_fat(fs->curr_clust);
+		if (((WORD)fp->fptr % 512) == 0) {				/* On the sector boundary? */
+			if ((fp->fptr / 512 % fs->csize) == 0) {	/* On the cluster boundary? */
+				clst = (fp->fptr == 0) ?			/* On the top of the file? */
+					fp->org_clust : get_fat(fp->curr_clust);
 				if (clst <= 1) goto fw_abort;
-				fs->curr_clust = clst;				/* Update current cluster */
-				fs->csect = 0;						/* Reset sector offset in the cluster */
+				fp->curr_clust = clst;				/* Update current cluster */
+				fp->csect = 0;						/* Reset sector offset in the cluster */
 			}
-			sect = clust2sect(fs->curr_clust);		/* Get current sector */
+			sect = clust2sect(fp->curr_clust);		/* Get current sector */
 			if (!sect) goto fw_abort;
-			fs->dsect = sect + fs->csect++;
-			if (disk_writep(0, fs->dsect)) goto fw_abort;	/* Initiate a sector write operation */
-			fs->flag |= FA__WIP;
+			fp->dsect = sect + fp->csect++;
+			if (disk_writep(0, fp->dsect)) goto fw_abort;	/* Initiate a sector write operation */
+			fp->flag |= FA__WIP;
 		}
-		wcnt = 512 - ((WORD)fs->fptr % 512);		/* Number of bytes to write to the sector */
+		wcnt = 512 - ((WORD)fp->fptr % 512);		/* Number of bytes to write to the sector */
 		if (wcnt > btw) wcnt = btw;
 		if (disk_writep(p, wcnt)) goto fw_abort;	/* Send data to the sector */
-		fs->fptr += wcnt; p += wcnt;				/* Update pointers and counters */
+		fp->fptr += wcnt; p += wcnt;				/* Update pointers and counters */
 		btw -= wcnt; *bw += wcnt;
-		if (((WORD)fs->fptr % 512) == 0) {
+		if (((WORD)fp->fptr % 512) == 0) {
 			if (disk_writep(0, 0)) goto fw_abort;	/* Finalize the currtent secter write operation */
-			fs->flag &= ~FA__WIP;
+			fp->flag &= ~FA__WIP;
 		}
 	}
 
 	return FR_OK;
 
 fw_abort:
-	fs->flag = 0;
+	fp->flag = 0;
+	return FR_DISK_ERR;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Write Whole Sectors                                                   */
+/*-----------------------------------------------------------------------*/
+/* Fast path for pre-allocated files such as save slots. The file pointer
+/  must be on a sector boundary. Every run of contiguous clusters is sent
+/  with one multiple block write, without the read-modify and zero padding
+/  finalization of pf_write(). The file is never extended. */
+
+FRESULT pf_write_sectors (
+	const void* buff,	/* Pointer to the data to be written (nsect * 512 bytes) */
+	WORD nsect,			/* Number of sectors to write */
+	WORD* sw			/* Pointer to number of sectors written */
+)
+{
+	CLUST clst, nclst;
+	DWORD sect, remain;
+	const BYTE *p = buff;
+	WORD wcnt, run;
+	FATFS *fs = FatFs;
+	FIL *fp;
+
+
+	*sw = 0;
+	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
+	fp = &fs->file;
+	if (!(fp->flag & FA_OPENED))		/* Check if opened */
+		return FR_NOT_OPENED;
+	if ((fp->flag & FA__WIP) || (fp->fptr % 512))	/* Check alignment */
+		return FR_NOT_ALIGNED;
+
+	remain = (fp->fsize - fp->fptr + 511) / 512;	/* Allocated sectors left */
+	if (nsect > remain) nsect = (WORD)remain;
+
+	while (nsect) {
+		if ((fp->fptr / 512 % fs->csize) == 0) {	/* On the cluster boundary? */
+			clst = (fp->fptr == 0) ?			/* On the top of the file? */
+				fp->org_clust : get_fat(fp->curr_clust);
+			if (clst <= 1) goto fs_abort;
+			fp->curr_clust = clst;				/* Update current cluster */
+			fp->csect = 0;						/* Reset sector offset in the cluster */
+		}
+		sect = clust2sect(fp->curr_clust);		/* Get current sector */
+		if (!sect) goto fs_abort;
+
+		run = fs->csize - fp->csect;			/* Sectors left in the current cluster */
+		clst = fp->curr_clust;
+		while (run < nsect) {					/* Merge following clusters while contiguous */
+			nclst = get_fat(clst);
+			if (nclst != clst + 1 || nclst >= fs->max_clust) break;
+			clst = nclst;
+			run += fs->csize;
+		}
+		wcnt = (run < nsect) ? run : nsect;
+
+		if (disk_writem(p, sect + fp->csect, wcnt)) goto fs_abort;
+
+		/* Leave the pointers on the last written cluster as pf_read() expects */
+		run = fp->csect + wcnt - 1;
+		fp->curr_clust += run / fs->csize;
+		fp->csect = (BYTE)(run % fs->csize + 1);
+		fp->fptr += (DWORD)wcnt * 512;
+		p += (DWORD)wcnt * 512;
+		nsect -= wcnt; *sw += wcnt;
+	}
+
+	return FR_OK;
+
+fs_abort:
+	fp->flag = 0;
 	return FR_DISK_ERR;
 }
 #endif
@@ -704,7 +1002,8 @@ fw_abort:
 /*-----------------------------------------------------------------------*/
 #if _USE_LSEEK
 
-FRESULT pf_lseek (
+FRESULT pf_flseek (
+	FIL *fp,		/* Pointer to the file object */
 	DWORD ofs		/* File pointer from top of file */
 )
 {
@@ -714,48 +1013,157 @@ FRESULT pf_lseek (
 
 
 	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
-	if (!(fs->flag & FA_OPENED))		/* Check if opened */
+	if (!(fp->flag & FA_OPENED))		/* Check if opened */
 			return FR_NOT_OPENED;
 
-	if (ofs > fs->fsize) ofs = fs->fsize;	/* Clip offset with the file size */
-	ifptr = fs->fptr;
-	fs->fptr = 0;
+	if (ofs > fp->fsize) ofs = fp->fsize;	/* Clip offset with the file size */
+	ifptr = fp->fptr;
+	fp->fptr = 0;
 	if (ofs > 0) {
 		bcs = (DWORD)fs->csize * 512;	/* Cluster size (byte) */
-		if (ifptr > 0 &&
+		if (fp->cltbl) {					/* When the run map is available, */
+			clst = clmt_clust(fp, ofs - 1);	/* get the cluster without following the chain */
+			if (!clst) goto fe_abort;
+			fp->curr_clust = clst;
+			fp->fptr = (ofs - 1) & ~(bcs - 1);
+			ofs -= fp->fptr;
+		} else if (ifptr > 0 &&
 			(ofs - 1) / bcs >= (ifptr - 1) / bcs) {	/* When seek to same or following cluster, */
-			fs->fptr = (ifptr - 1) & ~(bcs - 1);	/* start from the current cluster */
-			ofs -= fs->fptr;
-			clst = fs->curr_clust;
+			fp->fptr = (ifptr - 1) & ~(bcs - 1);	/* start from the current cluster */
+			ofs -= fp->fptr;
+			clst = fp->curr_clust;
 		} else {							/* When seek to back cluster, */
-			clst = fs->org_clust;			/* start from the first cluster */
-			fs->curr_clust = clst;
+			clst = fp->org_clust;			/* start from the first cluster */
+			fp->curr_clust = clst;
 		}
 		while (ofs > bcs) {				/* Cluster following loop */
 			clst = get_fat(clst);		/* Follow cluster chain */
 			if (clst <= 1 || clst >= fs->max_clust) goto fe_abort;
-			fs->curr_clust = clst;
-			fs->fptr += bcs;
+			fp->curr_clust = clst;
+			fp->fptr += bcs;
 			ofs -= bcs;
 		}
-		fs->fptr += ofs;
+		fp->fptr += ofs;
 		sect = clust2sect(clst);		/* Current sector */
 		if (!sect) goto fe_abort;
-		fs->csect = (BYTE)(ofs / 512);	/* Sector offset in the cluster */
+		fp->csect = (BYTE)(ofs / 512);	/* Sector offset in the cluster */
 		if (ofs % 512)
-			fs->dsect = sect + fs->csect++;
+			fp->dsect = sect + fp->csect++;
 	}
 
 	return FR_OK;
 
 fe_abort:
-	fs->flag = 0;
+	fp->flag = 0;
 	return FR_DISK_ERR;
 }
+
+
+FRESULT pf_lseek (
+	DWORD ofs		/* File pointer from top of file */
+)
+{
+	if (!FatFs) return FR_NOT_ENABLED;	/* Check file system */
+
+	return pf_flseek(&FatFs->file, ofs);
+}
 #endif
 
 
 
+
+/*-----------------------------------------------------------------------*/
+/* Build the Cluster Run Map of a File                                   */
+/*-----------------------------------------------------------------------*/
+/* tbl[0] holds the table size in items on entry. The map is a list of
+/  {run length, start cluster} pairs terminated by a zero. Once attached,
+/  pf_fread() and pf_flseek() never read the FAT for this file again.
+/  On FR_NOT_ENOUGH_CORE, tbl[0] is set to the required size. */
+
+FRESULT pf_fmap (
+	FIL *fp,		/* Pointer to the file object */
+	DWORD *tbl		/* Pointer to the run map table */
+)
+{
+	CLUST cl, pcl, tcl;
+	DWORD ncl, ulen, tlen, *p;
+	FATFS *fs = FatFs;
+
+
+	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
+	if (!(fp->flag & FA_OPENED))		/* Check if opened */
+		return FR_NOT_OPENED;
+
+	fp->cltbl = 0;
+	tlen = *tbl;
+	p = tbl + 1;
+	ulen = 2;							/* Size item and terminator */
+	cl = fp->org_clust;
+	if (cl) {
+		do {
+			tcl = cl; ncl = 0; ulen += 2;	/* Top of the new run */
+			do {
+				pcl = cl; ncl++;
+				cl = get_fat(cl);
+				if (cl <= 1) return FR_DISK_ERR;
+			} while (cl == pcl + 1);		/* Until the run is broken */
+			if (ulen <= tlen) {
+				*p++ = ncl; *p++ = tcl;
+			}
+		} while (cl < fs->max_clust);		/* Until end of the chain */
+	}
+	*tbl = ulen;
+	if (ulen > tlen) return FR_NOT_ENOUGH_CORE;
+	*p = 0;
+	fp->cltbl = tbl;
+
+	return FR_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Get Start Sector of a Contiguous File                                 */
+/*-----------------------------------------------------------------------*/
+/* Follows the cluster chain of the open file once. When every cluster
+/  follows its predecessor, the file is a plain run of sectors and can be
+/  read with disk_readm() without touching the FAT again. */
+
+FRESULT pf_contig (
+	DWORD* sect,	/* Pointer to store the start sector (lba) of the file */
+	DWORD* size		/* Pointer to store the file size */
+)
+{
+	CLUST clst, nclst;
+	DWORD ncl;
+	FATFS *fs = FatFs;
+	FIL *fp;
+
+
+	*sect = 0;
+	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
+	fp = &fs->file;
+	if (!(fp->flag & FA_OPENED))		/* Check if opened */
+		return FR_NOT_OPENED;
+
+	*size = fp->fsize;
+	clst = fp->org_clust;
+	ncl = (fp->fsize + (DWORD)fs->csize * 512 - 1) / ((DWORD)fs->csize * 512);	/* Clusters in the file */
+	while (ncl > 1) {
+		nclst = get_fat(clst);
+		if (nclst <= 1) return FR_DISK_ERR;
+		if (nclst != clst + 1) return FR_NOT_CONTIG;	/* Fragmented */
+		clst = nclst;
+		ncl--;
+	}
+
+	*sect = clust2sect(fp->org_clust);
+	return *sect ? FR_OK : FR_DISK_ERR;
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Create a Directroy Object                                             */
 /*-----------------------------------------------------------------------*/
@@ -32,10 +32,14 @@
 
 #define	_USE_LSEEK	1	/* pf_lseek(): 0:Remove ,1:Enable */
 
-#define	_USE_WRITE	0	/* pf_write(): 0:Remove ,1:Enable */
+#define	_USE_WRITE	0	/* pf_write() and pf_write_sectors(): 0:Remove ,1:Enable
+					/  The bootloader never writes, game projects set this to 1. */
 
 #define _FS_FAT32	1	/* 0:Supports FAT12/16 only, 1:Enable FAT32 supprt */
 
+#define _USE_MOUNT_CACHE	1	/* Cache volume parameters across boots: 0:Disable ,1:Enable
+							/  (needs disk_read_cid() and disk_cache_load/store() in diskio) */
+
 
 #define	_CODE_PAGE	1
 /* Defines which code page is used for path name. Supported code pages are:
@@ -70,24 +74,33 @@
 #endif
 
 
+/* File object structure */
+
+typedef struct _FIL_ {
+	BYTE	flag;		/* File status flags */
+	BYTE	csect;		/* File sector address in the cluster */
+	DWORD	fptr;		/* File R/W pointer */
+	DWORD	fsize;		/* File size */
+	CLUST	org_clust;	/* File start cluster */
+	CLUST	curr_clust;	/* File current cluster */
+	DWORD	dsect;		/* File current data sector */
+	DWORD*	cltbl;		/* Pointer to the cluster run map (NULL: Follow the FAT) */
+} FIL;
+
+
+
 /* File system object structure */
 
 typedef struct _FATFS_ {
 	BYTE	fs_type;	/* FAT sub type */
 	BYTE	csize;		/* Number of sectors per cluster */
-	BYTE	flag;		/* File status flags */
-	BYTE	csect;		/* File sector address in the cluster */
 	WORD	n_rootdir;	/* Number of root directory entries (0 on FAT32) */
 	BYTE*	buf;		/* Pointer to the disk access buffer */
 	CLUST	max_clust;	/* Maximum cluster# + 1. Number of clusters is max_clust - 2 */
 	DWORD	fatbase;	/* FAT start sector */
 	DWORD	dirbase;	/* Root directory start sector (Cluster# on FAT32) */
 	DWORD	database;	/* Data start sector */
-	DWORD	fptr;		/* File R/W pointer */
-	DWORD	fsize;		/* File size */
-	CLUST	org_clust;	/* File start cluster */
-	CLUST	curr_clust;	/* File current cluster */
-	DWORD	dsect;		/* File current data sector */
+	FIL		file;		/* File object used by pf_open/pf_read/pf_write/pf_lseek */
 } FATFS;
 
 
@@ -126,7 +139,10 @@ typedef enum {
 	FR_NO_PATH,			/* 4 */
 	FR_NOT_OPENED,		/* 5 */
 	FR_NOT_ENABLED,		/* 6 */
-	FR_NO_FILESYSTEM	/* 7 */
+	FR_NO_FILESYSTEM,	/* 7 */
+	FR_NOT_ALIGNED,		/* 8 */
+	FR_NOT_CONTIG,		/* 9 */
+	FR_NOT_ENOUGH_CORE	/* 10 */
 } FRESULT;
 
 
@@ -138,7 +154,14 @@ FRESULT pf_mount (FATFS*);						/* Mount/Unmount a logical drive */
 FRESULT pf_open (const char*);					/* Open a file */
 FRESULT pf_read (void*, WORD, WORD*);			/* Read data from the open file */
 FRESULT pf_write (const void*, WORD, WORD*);	/* Write data to the open file */
+FRESULT pf_write_sectors (const void*, WORD, WORD*);	/* Write whole sectors to the open file */
 FRESULT pf_lseek (DWORD);						/* Move file pointer of the open file */
+FRESULT pf_contig (DWORD*, DWORD*);				/* Get start sector and size of the open file if it is contiguous */
+FRESULT pf_fopen (FIL*, const char*);			/* Open a file into a caller owned file object */
+FRESULT pf_fopen_clust (FIL*, CLUST, DWORD);	/* Open a file object by start cluster and size */
+FRESULT pf_fread (FIL*, void*, WORD, WORD*);	/* Read data from a file object */
+FRESULT pf_flseek (FIL*, DWORD);				/* Move file pointer of a file object */
+FRESULT pf_fmap (FIL*, DWORD*);					/* Build the cluster run map of a file object */
 FRESULT pf_opendir (DIR*, const char*);			/* Open a directory */
 FRESULT pf_readdir (DIR*, FILINFO*);			/* Read a directory item from the open directory */
 
@@ -147,7 +170,7 @@ FRESULT pf_readdir (DIR*, FILINFO*);			/* Read a directory item from the open di
 /*--------------------------------------------------------------*/
 /* Flags and offset address                                     */
 
-/* File status flag (FATFS.flag) */
+/* File status flag (FIL.flag) */
 
 #define	FA_OPENED	0x01
 #define	FA_WPRT		0x02
@@ -0,0 +1,69 @@
+/*
+ * prof.h
+ *
+ * Created: 10/19/2026
+ *
+ * Boot time profiler . Timer1 runs free from prof_start() , prof_mark()
+ * stamps the end of each boot phase . The report gives the time of every
+ * phase in ms and a few counters , over the UART and/or saved in EEPROM so
+ * the next boot (or the application) can show it . Saving is built with
+ * -DPROF_SAVE only : the stamps differ on every boot , so each save
+ * rewrites EEPROM cells (about 3.4 ms a byte) before the application starts .
+ *
+ * Timer1 is polled , no interrupt is used . Its overflow is caught on every
+ * prof_now() , so marks must be less than 8.3 s apart .
+ *
+ * Build with -DPROF_SIMAVR and simavr's include path (simavr/sim/avr) to
+ * tag the ELF with MCU and F_CPU : "simavr bootloader.elf" then runs it
+ * without options and every run gives the same tick counts . There is no
+ * SD card model , the mount fails after its retries and profiles that path .
+ */
+
+
+#ifndef PROF_H_
+#define PROF_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+/*========== Constants ==========================*/
+
+#ifndef F_CPU
+   #define F_CPU 8000000UL
+#endif
+
+#ifndef TIFR1
+   #define TIFR1   TIFR   // ATmega32
+#endif
+
+#define PROF_PRESCALER      1024
+#define PROF_EEADDR         0x0050   // EEPROM address of the saved profile , after the image record .
+
+// Phases , each mark ends the phase of the same name
+#define PROF_MOUNT          0   // SD card initialised and volume mounted
+#define PROF_LOCATE         1   // Partition / directory / catalog scan
+#define PROF_HEADER         2   // Image header read and checked
+#define PROF_PROGRAM        3   // Image read , pages assembled and queued
+#define PROF_FLUSH          4   // Last queued pages erased and written
+#define PROF_VERIFY         5   // Flash read back and checked
+#define PROF_PHASES         6
+
+// Counters
+#define PROF_CNT_RETRIES    0   // Mount attempts that failed
+#define PROF_CNT_WRITTEN    1   // Pages erased and written
+#define PROF_CNT_SKIPPED    2   // Pages left unchanged
+#define PROF_COUNTERS       3
+
+/*========== Functions prototypes ==========================*/
+
+void prof_start(void) ;
+uint32_t prof_now(void) ;
+void prof_mark( uint8_t phase ) ;
+void prof_count( uint8_t counter , uint16_t value ) ;
+void prof_stop(void) ;
+void prof_report(void) ;
+void prof_save(void) ;
+uint8_t prof_load(void) ;
+
+
+#endif /* PROF_H_ */
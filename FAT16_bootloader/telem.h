@@ -0,0 +1,37 @@
+/*
+ * telem.h
+ *
+ * Created: 10/19/2026
+ *
+ * Binary telemetry over the UART (see telemfmt.h) , decoded on the host
+ * by tools/telemdec . Records go into the transmit buffer and are sent by
+ * the UDRE interrupt , a call costs the encoding only and never waits : a
+ * record the buffer has no room for is dropped whole and counted .
+ *
+ * Needs interrupts enabled and a transmit buffer larger than one frame
+ * (TELEM_MAX_FRAME) , e.g. -DUART_TX_SIZE=128 . Call from the main loop
+ * only (the transmit buffer has a single producer) and do not mix with
+ * text output on the same port . At 8 MHz 250000 , 500000 and 1000000
+ * baud are exact (Uart_init() picks U2X as needed) .
+ */
+
+
+#ifndef TELEM_H_
+#define TELEM_H_
+
+#include <stdint.h>
+
+#include "telemfmt.h"
+
+/*========== Functions prototypes ==========================*/
+
+uint8_t telem_send( uint8_t type , const uint8_t *payload , uint8_t len ) ;
+uint8_t telem_counter( uint8_t id , uint32_t value ) ;
+uint8_t telem_frame( uint16_t frame , uint16_t frame_us , uint16_t busy_us ) ;
+uint8_t telem_sd( uint32_t sectors , uint16_t errors , uint16_t read_us ) ;
+uint8_t telem_event( uint16_t id , const uint8_t *data , uint8_t len ) ;
+uint16_t telem_dropped(void) ;
+
+
+
+#endif /* TELEM_H_ */
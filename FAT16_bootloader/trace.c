@@ -0,0 +1,101 @@
+/*
+ * trace.c
+ *
+ * Created: 10/19/2026
+ *
+ * Event trace ring and its dump over the UART , see trace.h .
+ */
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "uart.h"
+#include "telem.h"
+#include "trace.h"
+
+#ifdef TRACE_ENABLE
+
+#ifndef F_CPU
+   #define F_CPU 8000000UL
+#endif
+
+#define TRACE_TICK_NS      ( TRACE_PRESCALER * 1000000UL / (F_CPU / 1000UL) )
+#define TRACE_PER_RECORD   ( (TELEM_MAX_PAYLOAD - 4) / 5 )
+
+#if (UART_TX_SIZE < TELEM_MAX_FRAME)
+   #error "trace_dump() needs -DUART_TX_SIZE=64 or more"
+#endif
+
+TRACE_ENTRY trace_buf[TRACE_SIZE] ;
+uint16_t trace_count ;
+
+void trace_start(void)
+{
+	// Timer1 normal mode , free running at F_CPU / TRACE_PRESCALER .
+	TCCR1A = 0 ;
+	#if (TRACE_PRESCALER == 1)
+	   TCCR1B = (1<<CS10) ;
+	#elif (TRACE_PRESCALER == 8)
+	   TCCR1B = (1<<CS11) ;
+	#elif (TRACE_PRESCALER == 64)
+	   TCCR1B = (1<<CS11) | (1<<CS10) ;
+	#elif (TRACE_PRESCALER == 256)
+	   TCCR1B = (1<<CS12) ;
+	#elif (TRACE_PRESCALER == 1024)
+	   TCCR1B = (1<<CS12) | (1<<CS10) ;
+	#else
+	   #error "TRACE_PRESCALER must be 1 , 8 , 64 , 256 or 1024"
+	#endif
+	trace_clear() ;
+}
+
+void trace_clear(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		trace_count = 0 ;
+	}
+}
+
+void trace_dump(void)
+{
+	// Oldest entry first , TRACE_PER_RECORD entries per TELEM_TRACE record . Waits for room in the
+	// transmit buffer , interrupts must be enabled . Events traced meanwhile may replace old ones .
+	uint8_t p[TELEM_MAX_PAYLOAD] ;
+	uint8_t n = 4 ;
+	uint16_t count , i ;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		count = trace_count ;
+	}
+	i = (count > TRACE_SIZE) ? count - TRACE_SIZE : 0 ;
+	p[0] = (uint8_t)TRACE_TICK_NS ;
+	p[1] = (uint8_t)(TRACE_TICK_NS >> 8) ;
+	p[2] = (uint8_t)(TRACE_TICK_NS >> 16) ;
+	p[3] = (uint8_t)(TRACE_TICK_NS >> 24) ;
+
+	for( ; i != count ; i++)
+	{
+		TRACE_ENTRY e ;
+
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			e = trace_buf[(uint8_t)i & (TRACE_SIZE - 1)] ;
+		}
+		p[n++] = e.id ;
+		p[n++] = e.time ;
+		p[n++] = e.time >> 8 ;
+		p[n++] = e.arg ;
+		p[n++] = e.arg >> 8 ;
+
+		if(n == 4 + TRACE_PER_RECORD * 5 || i + 1 == count)
+		{
+			while(Uart_Tx_Free() < TELEM_MAX_FRAME) ;
+			telem_send(TELEM_TRACE , p , n) ;
+			n = 4 ;
+		}
+	}
+}
+
+#endif /* TRACE_ENABLE */
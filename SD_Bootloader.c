@@ -15,10 +15,23 @@
    to start burn boot loader hex file in boot section in flash memory you should do that :
    1- open project -> properties ->Toolchain->AVR/GNU c linker -> miscellaneous 
    2- In other linker flags paste this line: "-Wl,--section-start=.text=0xE000" without quotes "" .
+   0xE000 is the ATmega644P boot section , see mcu.h for ATmega32 / ATmega1284P .
    
  NOTE 3 : 
    If you build your boot loader project in optimization level that target also should be build in same level !! .   
 
+ NOTE 4 :
+   Instead of the bin file of NOTE 1 you can wrap target.hex directly : tools/mkimage -x target.hex app.img .
+
+ NOTE 5 :
+   During development send the image over the UART instead of writing the card : start
+   tools/upload /dev/ttyUSB0 app.img then reset the board (mkimage images without -x) .
+
+ NOTE 6 :
+   Applications can program flash through bootsvc.h (bootsvc.c is part of this project) .
+   Add to the other linker flags of NOTE 2 : "-Wl,--section-start=.bootsvc=0xFFE0 -Wl,--undefined=bootsvc_table" .
+   The application includes bootsvc.h only , it must not link bootsvc.c .
+
  */ 
 
 #define F_CPU 8000000UL
@@ -34,6 +47,13 @@
 
 #include "sd.h"
 #include "uart.h"
+#include "flash.h"
+#include "image.h"
+#include "ihex.h"
+#include "crc.h"
+#include "prof.h"
+#include "upload.h"
+#include "mcu.h"
 
 #define ENABLED   1
 #define DISABLED  2
@@ -42,17 +62,28 @@
 
 #define MOUNT_ITERATION_MAX     128 
 #define MOUNT_ERROR_NOT_FOUND   0xFF
-#define APP_NO_SECTORS          10  // To-do : auto detect .
-#define APP_OFFSET_SECTOR       647  // To-do : auto detect but now u can detect it from winhex program .
-#define APPLICATION_FLASH_ADD   0x0000  // To-do : we can get it from hex file 
+#define APP_OFFSET_SECTOR       647  // Image header sector on cards without an IMG_PART_TYPE partition .
+#define APPLICATION_FLASH_ADD   0x0000  // Application reset vector .
+#define BOOT_SECTION_ADD        MCU_BOOT_START  // Same as .text section start (NOTE 2) , images must end below it .
+#define PAGES_PER_SECTOR        (SECTOR_SIZE / SPM_PAGESIZE)  // 2 on ATmega644P / ATmega1284P , 4 on ATmega32 .
+
+#if (SECTOR_SIZE % SPM_PAGESIZE)
+   #error "flash pages must divide the SD sector"
+#endif
+
+UART_BAUD_CHECK(UPLOAD_BAUD) ;  // Within 2 % at this F_CPU , else the upload would fail .
 
 /*================================= Macros =============================*/
 #define debug(ASSERTION,EN,... ) {\
 	if(ASSERTION){ \
 		if(EN) Uart_Transimit_String(__VA_ARGS__) ; \
+		profile_end() ; \
 		return 0 ; }}
 /*================================= Function definitions =============================*/		
-void boot_program_page (uint32_t page, uint8_t *buf) ;
+static uint8_t program_bin( const IMAGE_INFO *image , uint8_t buf[2][SECTOR_SIZE] ) ;
+static uint8_t program_hex( const IMAGE_INFO *image , uint8_t *buf ) ;
+static void profile_end(void) ;
+static void start_application(void) ;
 
 /*================================= Main Function =============================*/		
 
@@ -60,15 +91,29 @@ int main(void)
 {
 	uint8_t mount_status = 0xFF ;
 	int iterations = 0  , i = 0;
-	volatile uint8_t app_bin_buff[512] ;
+	uint8_t app_bin_buff[2][SECTOR_SIZE] ;  // Read one sector while the other one is being flashed .
+	IMAGE_INFO image ;
+	
+	// 0 - Image sent by tools/upload over the UART , the card is not needed then .
+	//     UART ISRs run from the boot section , also while pages are programmed .
+	flash_boot_vectors(1) ;
+	Uart_init(UPLOAD_BAUD) ;
+	Uart_Set_Tx_Timeout(10) ;  // Formatted debug output (sd.c) waits for room instead of being dropped .
+	uint8_t upload = upload_run(BOOT_SECTION_ADD , &image) ;
+	if(upload == UPLOAD_DONE)
+	   start_application() ;
 	
 	#if ( DEBUG_MODE == ENABLED )
-	Uart_init(9600) ;
+	if(upload == UPLOAD_FAILED)
+	   Uart_Transimit_String("\nUART upload failed!!") ;
 	_delay_ms(100) ;
 	Uart_Transimit_String("\nLoading SD Card ...") ;
 	#endif
+	prof_start() ;
 	// 1 - Wait while for mounting SD card 
     while( ((mount_status = SD_mount()) == 0xFF) && (iterations++ < MOUNT_ITERATION_MAX) ) ;
+	prof_mark(PROF_MOUNT) ;
+	prof_count(PROF_CNT_RETRIES , iterations) ;
 	
 	//2- Check if SD card mounted successfully or not.
 	
@@ -78,49 +123,137 @@ int main(void)
         	Uart_Transimit_String("\nSD Card mounted successfully!!") ;
 	  #endif
 		
-		// 3 - Retrieve application program from sd card sector by sector and store it sector by sector .
-		// (each sector contain 2 page in atmega644p) in flash memory .
+		// 3 - Find the image (partition of type IMG_PART_TYPE or the fixed sector) and check its header .
+		
+		uint32_t hdr_sector ;
+		if( SD_Find_Partition(IMG_PART_TYPE , app_bin_buff[0] , &hdr_sector) != 0 )
+		   hdr_sector = APP_OFFSET_SECTOR ;
+		prof_mark(PROF_LOCATE) ;
 		
-		for( int i = 0 ; i<APP_NO_SECTORS ; i++)
+		uint8_t rd = SD_Read_Sector(hdr_sector , app_bin_buff[0]) ;
+		debug((rd != 0) , DEBUG_MODE ,"\nRead sector failed!!");
+		debug((image_parse_header(app_bin_buff[0] , BOOT_SECTION_ADD , &image) != IMG_OK) , DEBUG_MODE ,"\nNo valid application image!!");
+		image.sector = hdr_sector + 1 ;
+		prof_mark(PROF_HEADER) ;
+		
+		// Same image as the last verified update : nothing to program .
+		if( image_is_flashed(&image) )
 		{
-			uint8_t rd = SD_Read_Sector(APP_OFFSET_SECTOR+i , app_bin_buff) ;
-			debug((rd == 0xFF) , DEBUG_MODE ,"\nRead sector failed!!");
-			
-			boot_program_page( APPLICATION_FLASH_ADD + (i*512)      , app_bin_buff     ) ;
-			boot_program_page( APPLICATION_FLASH_ADD + (i*512) + 256 , app_bin_buff +256) ;
+			#if ( DEBUG_MODE == ENABLED )
+			Uart_Transimit_String("\nApplication is up to date") ;
+			#endif
+			profile_end() ;
+			start_application() ;
 		}
+		image_forget() ;
+		
+		// 4 - Retrieve application program from sd card and store it in flash memory .
 		
-		//4- Now jump to application program ... enjoy :) .
-	    ( (void (*)(void)) APPLICATION_FLASH_ADD)() ;	
+		SD_Set_Idle_Hook(flash_poll) ;
+		uint8_t ok = (image.flags & IMG_FLAG_IHEX) ? program_hex(&image , app_bin_buff[0]) : program_bin(&image , app_bin_buff) ;
+		SD_Set_Idle_Hook(0) ;
+		if(!ok)
+		   return 0 ;
+		
+		#if ( DEBUG_MODE == ENABLED )
+		Uart_Transimit_String("\nPages written : ") ;
+		Uart_Print_Int(flash_pages_written()) ;
+		Uart_Transimit_String(" , unchanged : ") ;
+		Uart_Print_Int(flash_pages_skipped()) ;
+		#endif
+		
+		// 5- Remember the image , next reset jumps to the application directly .
+		image_mark_flashed(&image) ;
+		profile_end() ;
+		
+		//6- Now jump to application program ... enjoy :) .
+	    start_application() ;	
 }
 
 
+static uint8_t program_bin( const IMAGE_INFO *image , uint8_t buf[2][SECTOR_SIZE] )
+{
+	// Binary image : sector by sector , each sector contain PAGES_PER_SECTOR pages , only the pages the image really uses .
+	// Pages of the previous sector are erased/written in background while the next sector is read .
+	uint16_t sectors = (image->pages + PAGES_PER_SECTOR - 1) / PAGES_PER_SECTOR ;
+	uint16_t page = 0 ;
+	
+	for( uint16_t i = 0 ; i<sectors ; i++)
+	{
+		uint8_t *sec = buf[i & 1] ;
+		
+		// Wait until the pages of sector i-2 (same buffer) are in the SPM buffer .
+		while(flash_queued() > PAGES_PER_SECTOR) flash_poll() ;
+		
+		uint8_t rd = SD_Read_Sector(image->sector+i , sec) ;
+		debug((rd != 0) , DEBUG_MODE ,"\nRead sector failed!!");
+		
+		for(uint8_t p = 0 ; p<PAGES_PER_SECTOR && page<image->pages ; p++ , page++)
+		   flash_queue( image->load + (uint32_t)page*SPM_PAGESIZE , sec + p*SPM_PAGESIZE) ;
+	}
+	prof_mark(PROF_PROGRAM) ;
+	flash_flush() ;
+	prof_mark(PROF_FLUSH) ;
+	
+	// Read the programmed pages back and check them against the image CRC .
+	debug((image_flash_crc(image) != image->crc) , DEBUG_MODE ,"\nFlash verify failed!!");
+	prof_mark(PROF_VERIFY) ;
+	
+	return 1 ;
+}
+
+static void hex_out( uint32_t addr , const uint8_t *data , uint8_t count )
+{
+	flash_write(addr , data , count) ;
+}
 
-void boot_program_page (uint32_t page, uint8_t *buf)
+static uint8_t program_hex( const IMAGE_INFO *image , uint8_t *buf )
 {
-	//I will use 24 page eache page contain 256 byte [128 word] .
+	// Intel HEX image : records are parsed while streaming and assembled into pages ,
+	// only pages the records touch are programmed .
+	uint32_t left = image->length , crc = CRC32_INIT ;
+	
+	ihex_init(hex_out , BOOT_SECTION_ADD) ;
+	for( uint16_t i = 0 ; left ; i++)
+	{
+		uint16_t n = (left < SECTOR_SIZE) ? left : SECTOR_SIZE ;
+		
+		uint8_t rd = SD_Read_Sector(image->sector+i , buf) ;
+		debug((rd != 0) , DEBUG_MODE ,"\nRead sector failed!!");
+		
+		crc = crc32_update(crc , buf , n) ;
+		ihex_feed(buf , n) ;
+		left -= n ;
+	}
+	prof_mark(PROF_PROGRAM) ;
+	flash_flush() ;
+	prof_mark(PROF_FLUSH) ;
 	
+	debug((ihex_status() != IHEX_DONE) , DEBUG_MODE ,"\nBad HEX file!!");
+	debug((CRC32_FINAL(crc) != image->crc) , DEBUG_MODE ,"\nImage CRC mismatch!!");
+	prof_mark(PROF_VERIFY) ;
 	
-    uint16_t i;
-    uint8_t sreg;
-    // Disable interrupts.
-    sreg = SREG;
-    cli();
-    eeprom_busy_wait ();
-    boot_page_erase (page);
-    boot_spm_busy_wait ();      // Wait until the memory is erased.
-    for (i=0; i<SPM_PAGESIZE; i+=2 , buf += 2)
-    {
-        // Set up little-endian word.
-        uint16_t w = *( (uint16_t *) buf) ;
-    
-        boot_page_fill (page + i, w);
-    }
-    boot_page_write (page);     // Store buffer in flash page.
-    boot_spm_busy_wait();       // Wait until the memory is written.
-    // Reenable RWW-section again. We need this if we want to jump back
-    // to the application after bootloading.
-    boot_rww_enable ();
-    // Re-enable interrupts (if they were ever enabled).
-    SREG = sreg;
+	return 1 ;
+}
+static void profile_end(void)
+{
+	// Keep this boot's profile for the next boot / the application , Timer1 back to its reset state .
+	prof_count(PROF_CNT_WRITTEN , flash_pages_written()) ;
+	prof_count(PROF_CNT_SKIPPED , flash_pages_skipped()) ;
+	prof_stop() ;
+	#ifdef PROF_SAVE
+	prof_save() ;
+	#endif
+	#if ( DEBUG_MODE == ENABLED )
+	prof_report() ;
+	#endif
+}
+
+static void start_application(void)
+{
+	// Leave the MCU as after reset : interrupts and UART off , vectors back at address 0 .
+	cli() ;
+	Uart_Disable() ;
+	flash_boot_vectors(0) ;
+	( (void (*)(void)) APPLICATION_FLASH_ADD)() ;
 }
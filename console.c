@@ -0,0 +1,289 @@
+/*
+ * console.c
+ *
+ * Created: 10/19/2026
+ *
+ * Debug console , see console.h . The line is collected byte by byte in a
+ * CONSOLE_LINE buffer , split into words in place and run when CR or LF
+ * arrives , so no call waits for input .
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+#include "uart.h"
+#include "sd.h"
+#include "prof.h"
+#include "trace.h"
+#include "console.h"
+
+#define CONSOLE_ARGS      10   // Command word and its arguments
+#define TICK_US           ( PROF_PRESCALER * 1000UL / (F_CPU / 1000UL) )
+
+static char line[CONSOLE_LINE] ;
+static uint8_t line_len , line_lost ;
+
+static const CONSOLE_BENCH *bench_table ;
+static uint8_t bench_count ;
+static uint8_t *sector ;
+
+// Counter values at the last "perf clear" , perf shows the difference .
+static uint16_t rx_base , tx_base ;
+
+static uint8_t get_number( const char *str , uint32_t *value )
+{
+	// Decimal or 0x hex , 0 if str is not a number .
+	uint8_t base = 10 ;
+	uint32_t n = 0 ;
+
+	if(str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+	{
+		base = 16 ;
+		str += 2 ;
+	}
+	if(!*str)
+	   return 0 ;
+
+	for( ; *str ; str++)
+	{
+		uint8_t d ;
+		if(*str >= '0' && *str <= '9')       d = *str - '0' ;
+		else if(*str >= 'a' && *str <= 'f')  d = *str - 'a' + 10 ;
+		else if(*str >= 'A' && *str <= 'F')  d = *str - 'A' + 10 ;
+		else return 0 ;
+		if(d >= base)
+		   return 0 ;
+		n = n * base + d ;
+	}
+	*value = n ;
+	return 1 ;
+}
+
+static void dump( uint16_t addr , const uint8_t *data , uint16_t len )
+{
+	// 16 bytes per line : "0100: 00 11 22 ..." .
+	for(uint16_t i = 0 ; i<len ; i++)
+	{
+		if((i & 15) == 0)
+		   Uart_Printf("\n%04x:" , addr + i) ;
+		Uart_Printf(" %02x" , data[i]) ;
+	}
+}
+
+static void cmd_peek( uint8_t argc , char **argv )
+{
+	uint32_t addr , len = 16 ;
+
+	if(argc < 2 || !get_number(argv[1] , &addr) || (argc > 2 && !get_number(argv[2] , &len)) || len > 256)
+	{
+		Uart_Printf("\nusage: peek ADDR [N] , N up to 256") ;
+		return ;
+	}
+	dump(addr , (const uint8_t *)(uint16_t)addr , len) ;
+}
+
+static void cmd_poke( uint8_t argc , char **argv )
+{
+	uint32_t addr , value ;
+
+	if(argc < 3 || !get_number(argv[1] , &addr))
+	{
+		Uart_Printf("\nusage: poke ADDR BYTE ...") ;
+		return ;
+	}
+	// Check every byte first , a bad one writes nothing .
+	for(uint8_t i = 2 ; i<argc ; i++)
+	{
+		if(!get_number(argv[i] , &value) || value > 0xFF)
+		{
+			Uart_Printf("\nbad byte %s" , argv[i]) ;
+			return ;
+		}
+	}
+	for(uint8_t i = 2 ; i<argc ; i++)
+	{
+		get_number(argv[i] , &value) ;
+		*(volatile uint8_t *)(uint16_t)(addr + i - 2) = value ;
+	}
+}
+
+static void cmd_sd( uint8_t argc , char **argv )
+{
+	uint32_t sec ;
+
+	if(!sector)
+	{
+		Uart_Printf("\nno sector buffer") ;
+		return ;
+	}
+	if(argc < 2 || !get_number(argv[1] , &sec))
+	{
+		Uart_Printf("\nusage: sd SECTOR") ;
+		return ;
+	}
+
+	prof_start() ;
+	uint8_t rd = SD_Read_Sector(sec , sector) ;
+	uint32_t us = prof_now() * TICK_US ;
+	prof_stop() ;
+
+	if(rd)
+	{
+		Uart_Printf("\nsector %lu read failed (0x%02x)" , sec , rd) ;
+		return ;
+	}
+	dump(0 , sector , SECTOR_SIZE) ;
+	Uart_Printf("\nsector %lu : %lu us" , sec , us) ;
+}
+
+static void cmd_bench( uint8_t argc , char **argv )
+{
+	CONSOLE_BENCH b ;
+	uint32_t runs = 1 ;
+	uint8_t i ;
+
+	if(argc < 2)
+	{
+		for(i = 0 ; i<bench_count ; i++)
+		{
+			memcpy_P(&b , &bench_table[i] , sizeof(b)) ;
+			Uart_Printf("\n%s" , b.name) ;
+		}
+		return ;
+	}
+	for(i = 0 ; i<bench_count ; i++)
+	{
+		memcpy_P(&b , &bench_table[i] , sizeof(b)) ;
+		if(!strcmp(b.name , argv[1]))
+		   break ;
+	}
+	if(i == bench_count || (argc > 2 && (!get_number(argv[2] , &runs) || !runs)))
+	{
+		Uart_Printf("\nusage: bench [NAME [RUNS]] , bench lists the names") ;
+		return ;
+	}
+
+	// Time all runs at once , the 128 us tick is too coarse for one short run .
+	prof_start() ;
+	for(uint32_t r = 0 ; r<runs ; r++)
+	   b.run() ;
+	uint32_t us = prof_now() * TICK_US ;
+	prof_stop() ;
+
+	Uart_Printf("\n%s : %lu runs , %lu us , %lu us/run" , b.name , runs , us , us / runs) ;
+}
+
+static void cmd_perf( uint8_t argc , char **argv )
+{
+	if(argc > 1)
+	{
+		if(strcmp(argv[1] , "clear"))
+		{
+			Uart_Printf("\nusage: perf [clear]") ;
+			return ;
+		}
+		rx_base = Uart_Rx_Overflows() ;
+		tx_base = Uart_Tx_Overflows() ;
+		SD_Clear_Counters() ;
+		trace_clear() ;
+		return ;
+	}
+
+	Uart_Printf("\nrx overflows %u , tx overflows %u" , Uart_Rx_Overflows() - rx_base , Uart_Tx_Overflows() - tx_base) ;
+	Uart_Printf("\nsd reads %lu , errors %u" , SD_Reads() , SD_Read_Errors()) ;
+	#ifdef TRACE_ENABLE
+	Uart_Printf("\ntrace events %u" , trace_count) ;
+	#endif
+	if(prof_load())
+	{
+		// prof_report() writes UDR directly , let the transmit buffer drain first .
+		while(Uart_Tx_Free() != UART_TX_SIZE) ;
+		prof_report() ;
+	}
+}
+
+static void run_line(void)
+{
+	char *argv[CONSOLE_ARGS] ;
+	uint8_t argc = 0 ;
+	char *p = line ;
+
+	// Split at spaces in place .
+	while(*p && argc < CONSOLE_ARGS)
+	{
+		while(*p == ' ') *p++ = 0 ;
+		if(!*p) break ;
+		argv[argc++] = p ;
+		while(*p && *p != ' ') p++ ;
+	}
+	if(!argc)
+	   return ;
+
+	if(!strcmp(argv[0] , "peek"))        cmd_peek(argc , argv) ;
+	else if(!strcmp(argv[0] , "poke"))   cmd_poke(argc , argv) ;
+	else if(!strcmp(argv[0] , "sd"))     cmd_sd(argc , argv) ;
+	else if(!strcmp(argv[0] , "bench"))  cmd_bench(argc , argv) ;
+	else if(!strcmp(argv[0] , "perf"))   cmd_perf(argc , argv) ;
+	else if(!strcmp(argv[0] , "help"))
+	   Uart_Printf("\npeek ADDR [N] , poke ADDR BYTE ... , sd SECTOR , bench [NAME [RUNS]] , perf [clear]") ;
+	else
+	   Uart_Printf("\nunknown command %s , try help" , argv[0]) ;
+}
+
+void console_init( const CONSOLE_BENCH *benches , uint8_t count , uint8_t *sector_buf )
+{
+	// benches : table in flash , sector_buf : SECTOR_SIZE bytes for the sd command (0 : no sd command) .
+	bench_table = benches ;
+	bench_count = count ;
+	sector = sector_buf ;
+	line_len = line_lost = 0 ;
+	rx_base = Uart_Rx_Overflows() ;
+	tx_base = Uart_Tx_Overflows() ;
+	Uart_Set_Tx_Timeout(CONSOLE_TX_TIMEOUT) ;
+	Uart_Printf("\n> ") ;
+}
+
+void console_input( char ch )
+{
+	// One received byte , echoed . Backspace edits , a line longer than CONSOLE_LINE is refused whole .
+	if(ch == '\r' || ch == '\n')
+	{
+		if(line_lost)
+		   Uart_Printf("\nline too long") ;
+		else if(line_len)
+		{
+			line[line_len] = 0 ;
+			run_line() ;
+		}
+		else if(ch == '\n')
+		   return ;   // LF of a CR LF pair
+		line_len = line_lost = 0 ;
+		Uart_Printf("\n> ") ;
+	}
+	else if(ch == '\b' || ch == 0x7F)
+	{
+		if(line_len)
+		{
+			line_len-- ;
+			Uart_Printf("\b \b") ;
+		}
+	}
+	else if(ch >= ' ')
+	{
+		if(line_len < CONSOLE_LINE - 1)
+		   line[line_len++] = ch ;
+		else
+		   line_lost = 1 ;
+		put_TransBuffer_data(ch) ;
+	}
+}
+
+void console_poll(void)
+{
+	// Everything received so far , returns when the receive buffer is empty .
+	char ch ;
+
+	while( (ch = get_RecvBuffer_data()) )
+	   console_input(ch) ;
+}
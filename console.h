@@ -0,0 +1,60 @@
+/*
+ * console.h
+ *
+ * Created: 10/19/2026
+ *
+ * Debug console over the UART . console_poll() takes the received bytes out
+ * of the receive buffer and runs a command for every complete line , call
+ * it from the main loop . Commands (numbers decimal or 0x hex) :
+ *
+ *   peek ADDR [N]          N bytes of data space (RAM and I/O , default 16)
+ *   poke ADDR BYTE ...     write bytes to data space
+ *   sd SECTOR              read a card sector , dump it and its read time
+ *   bench [NAME [RUNS]]    run a benchmark of the table , list them without NAME
+ *   perf [clear]           UART overflows , SD reads (sd.c counts every read) and trace
+ *                          events since the last "perf clear" , then the saved boot profile
+ *   help
+ *
+ * Peek and poke go straight to the address , reading an I/O register such
+ * as UDR has its usual side effects . sd and bench time with prof_now()
+ * (Timer1 at clk/1024 , 128 us at 8 MHz) and leave Timer1 stopped like
+ * prof_stop() , a running trace_start() timer included . Keep benchmarks
+ * below 8 s and raise RUNS for short ones .
+ *
+ * Output goes through the transmit buffer with a CONSOLE_TX_TIMEOUT ms
+ * wait for room , interrupts must be enabled .
+ */
+
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#ifndef CONSOLE_LINE
+   #define CONSOLE_LINE         40   // Longest command line
+#endif
+#ifndef CONSOLE_TX_TIMEOUT
+   #define CONSOLE_TX_TIMEOUT   20   // ms , see Uart_Set_Tx_Timeout()
+#endif
+
+#define CONSOLE_NAME_LEN        12   // Benchmark name with its terminator
+
+/*========== Types ==========================*/
+
+typedef struct
+{
+	char name[CONSOLE_NAME_LEN] ;
+	void (*run)(void) ;
+}CONSOLE_BENCH ;   // Tables live in flash (PROGMEM)
+
+/*========== Functions prototypes ==========================*/
+
+void console_init( const CONSOLE_BENCH *benches , uint8_t count , uint8_t *sector_buf ) ;
+void console_poll(void) ;
+void console_input( char ch ) ;   // For other byte sources than the UART
+
+
+#endif /* CONSOLE_H_ */
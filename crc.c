@@ -0,0 +1,35 @@
+/*
+ * crc.c
+ *
+ * Created: 10/19/2026
+ *
+ * CRC-32 with a 16 entry (nibble) table kept in flash : 64 bytes of
+ * program memory and no SRAM , about 3 times faster than bit by bit .
+ */
+
+#include <avr/pgmspace.h>
+
+#include "crc.h"
+
+static const uint32_t crc_table[16] PROGMEM =
+{
+	0x00000000UL , 0x1DB71064UL , 0x3B6E20C8UL , 0x26D930ACUL ,
+	0x76DC4190UL , 0x6B6B51F4UL , 0x4DB26158UL , 0x5005713CUL ,
+	0xEDB88320UL , 0xF00F9344UL , 0xD6D6A3E8UL , 0xCB61B38CUL ,
+	0x9B64C2B0UL , 0x86D3D2D4UL , 0xA00AE278UL , 0xBDBDF21CUL
+};
+
+uint32_t crc32_byte( uint32_t crc , uint8_t data )
+{
+	crc ^= data ;
+	crc = (crc >> 4) ^ pgm_read_dword(&crc_table[crc & 0x0F]) ;
+	crc = (crc >> 4) ^ pgm_read_dword(&crc_table[crc & 0x0F]) ;
+	return crc ;
+}
+
+uint32_t crc32_update( uint32_t crc , const uint8_t *data , uint16_t count )
+{
+	while(count--)
+	   crc = crc32_byte(crc , *data++) ;
+	return crc ;
+}
@@ -0,0 +1,34 @@
+/*
+ * crc.h
+ *
+ * Created: 10/19/2026
+ *
+ * CRC-32 (IEEE 802.3 , reflected , same result as zlib crc32()) .
+ *
+ *   uint32_t crc = CRC32_INIT ;
+ *   crc = crc32_update(crc , data , count) ;   // as many times as needed
+ *   crc = CRC32_FINAL(crc) ;
+ */
+
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define CRC32_INIT        0xFFFFFFFFUL
+
+/*========== Macros ==========================*/
+
+#define CRC32_FINAL(CRC)  ( ~(CRC) )
+
+/*========== Functions prototypes ==========================*/
+
+uint32_t crc32_byte( uint32_t crc , uint8_t data ) ;
+uint32_t crc32_update( uint32_t crc , const uint8_t *data , uint16_t count ) ;
+
+
+
+#endif /* CRC_H_ */
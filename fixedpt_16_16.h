@@ -4,9 +4,11 @@ FIXED point manpulation unsing 32-bit representation 16.16 */
 #ifndef FIXEDPT_16_16_H
 #define FIXEDPT_16_16_H
 
+#include <stdint.h>
+
 /*Data structures*/
 
-typedef  int FIXPONT ;
+typedef  int32_t FIXPONT ;  // int is 16-bit on AVR , print with Uart_Printf("%q") .
 
 /*Constants*/
 
@@ -0,0 +1,116 @@
+/*
+ * image.c
+ *
+ * Created: 10/19/2026
+ *
+ * Validate an application image header (see imgfmt.h) and remember the
+ * last image that was flashed successfully .
+ *
+ * The EEPROM record holds load address , length and CRC of that image plus
+ * the inverted CRC as a validity check . It is cleared before the first page
+ * is erased and written only after the flash content has been verified , so
+ * an interrupted update never takes the fast path .
+ */
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+
+#include "crc.h"
+#include "image.h"
+
+#if (FLASHEND > 0xFFFFUL)
+   #define flash_read_byte(ADD)  pgm_read_byte_far(ADD)
+#else
+   #define flash_read_byte(ADD)  pgm_read_byte((uint16_t)(ADD))
+#endif
+
+typedef struct
+{
+	uint32_t load ;
+	uint32_t length ;
+	uint32_t crc ;
+	uint32_t crc_inv ;   // ~crc , a blank (0xFF) or cleared record never matches
+}IMAGE_RECORD ;
+
+static uint16_t ld16( const uint8_t *p )
+{
+	return p[0] | (uint16_t)p[1] << 8 ;
+}
+
+static uint32_t ld32( const uint8_t *p )
+{
+	return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24 ;
+}
+
+uint8_t image_parse_header( const uint8_t *hdr , uint32_t flash_end , IMAGE_INFO *info )
+{
+	// Check the first IMG_HDR_SIZE bytes of an image , flash_end is the first byte the image must not reach .
+	if(ld32(hdr + IMG_HDR_MAGIC) != IMG_MAGIC)
+	   return IMG_BAD_MAGIC ;
+	if(CRC32_FINAL(crc32_update(CRC32_INIT , hdr , IMG_HDR_HDR_CRC)) != ld32(hdr + IMG_HDR_HDR_CRC) ||
+	   ld16(hdr + IMG_HDR_VERSION) != IMG_VERSION)
+	   return IMG_BAD_HEADER ;
+	if(ld16(hdr + IMG_HDR_PAGE_SIZE) != SPM_PAGESIZE)
+	   return IMG_BAD_PAGE_SIZE ;
+
+	info->load   = ld32(hdr + IMG_HDR_LOAD) ;
+	info->length = ld32(hdr + IMG_HDR_LENGTH) ;
+	info->pages  = ld16(hdr + IMG_HDR_PAGES) ;
+	info->flags  = ld16(hdr + IMG_HDR_FLAGS) ;
+	info->crc    = ld32(hdr + IMG_HDR_CRC) ;
+
+	// HEX payloads are range checked record by record while parsing .
+	if( !(info->flags & IMG_FLAG_IHEX) &&
+	    ( (info->load % SPM_PAGESIZE) ||
+	      info->load >= flash_end || info->length > flash_end - info->load ||
+	      info->pages != (info->length + SPM_PAGESIZE - 1) / SPM_PAGESIZE ||
+	      (uint32_t)info->pages * SPM_PAGESIZE > flash_end - info->load ) )   // No sum , it could wrap past flash_end .
+	   return IMG_BAD_RANGE ;
+
+	return IMG_OK ;
+}
+
+uint32_t image_flash_crc( const IMAGE_INFO *info )
+{
+	// CRC-32 of the programmed binary read back from flash .
+	uint32_t crc = CRC32_INIT ;
+
+	for( uint32_t i = 0 ; i<info->length ; i++ )
+	   crc = crc32_byte(crc , flash_read_byte(info->load + i)) ;
+
+	return CRC32_FINAL(crc) ;
+}
+
+uint8_t image_is_flashed( const IMAGE_INFO *info )
+{
+	// 1 if this exact image was the last one flashed and verified .
+	IMAGE_RECORD rec ;
+
+	eeprom_read_block(&rec , (const void *)IMG_RECORD_EEADDR , sizeof(rec)) ;
+
+	return rec.crc_inv == ~rec.crc && rec.crc == info->crc &&
+	       rec.length == info->length && rec.load == info->load ;
+}
+
+void image_mark_flashed( const IMAGE_INFO *info )
+{
+	IMAGE_RECORD rec ;
+
+	rec.load = info->load ;
+	rec.length = info->length ;
+	rec.crc = info->crc ;
+	rec.crc_inv = ~info->crc ;
+	eeprom_update_block(&rec , (void *)IMG_RECORD_EEADDR , sizeof(rec)) ;
+}
+
+void image_forget(void)
+{
+	// Invalidate the record before the application flash is touched .
+	IMAGE_RECORD rec ;
+
+	memset(&rec , 0 , sizeof(rec)) ;
+	eeprom_update_block(&rec , (void *)IMG_RECORD_EEADDR , sizeof(rec)) ;
+}
@@ -0,0 +1,53 @@
+/*
+ * image.h
+ *
+ * Created: 10/19/2026
+ *
+ * Validate an application image header (see imgfmt.h) and remember the
+ * last image that was flashed successfully , so an unchanged card boots the
+ * application right after reading one header .
+ */
+
+
+#ifndef IMAGE_H_
+#define IMAGE_H_
+
+#include <stdint.h>
+
+#include "imgfmt.h"
+
+/*========== Constants ==========================*/
+
+#define IMG_RECORD_EEADDR   0x0040   // EEPROM address of the last flashed image record , after the FAT16 mount cache .
+
+// image_parse_header() results
+#define IMG_OK              0
+#define IMG_READ_ERROR      1
+#define IMG_BAD_MAGIC       2
+#define IMG_BAD_HEADER      3   // Header CRC or version mismatch
+#define IMG_BAD_PAGE_SIZE   4   // Built for another device
+#define IMG_BAD_RANGE       5   // Not page aligned or overlaps the boot section
+
+/*========== Types ==========================*/
+
+typedef struct
+{
+	uint32_t sector ;   // First sector of the binary (raw card only , set by the caller)
+	uint32_t load ;     // Flash byte address of the first page
+	uint32_t length ;   // Binary length in bytes
+	uint16_t pages ;    // Number of flash pages to program
+	uint16_t flags ;
+	uint32_t crc ;      // CRC-32 of the binary
+}IMAGE_INFO ;
+
+/*========== Functions prototypes ==========================*/
+
+uint8_t image_parse_header( const uint8_t *hdr , uint32_t flash_end , IMAGE_INFO *info ) ;
+uint32_t image_flash_crc( const IMAGE_INFO *info ) ;
+uint8_t image_is_flashed( const IMAGE_INFO *info ) ;
+void image_mark_flashed( const IMAGE_INFO *info ) ;
+void image_forget(void) ;
+
+
+
+#endif /* IMAGE_H_ */
@@ -0,0 +1,51 @@
+/*
+ * imgfmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * Application image layout on the card . Shared by image.c and tools/mkimage.c .
+ *
+ *  sector 0         : header , rest of the sector is zero
+ *  sector 1..       : application binary , padded with 0xFF to a whole page ,
+ *                     or Intel HEX text when IMG_FLAG_IHEX is set
+ *
+ * SD_Bootloader.c reads the image from the start of an MBR partition of type
+ * IMG_PART_TYPE (written raw , no file system) , or from a fixed sector on
+ * cards without one (APP_OFFSET_SECTOR) . The FAT16 bootloader accepts the
+ * same image as a plain file .
+ *
+ * All multi-byte fields are little-endian . CRCs are CRC-32 (IEEE 802.3 ,
+ * same as zlib) .
+ */
+
+
+#ifndef IMGFMT_H_
+#define IMGFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define IMG_MAGIC               0x474D4947UL   // "GIMG"
+#define IMG_VERSION             1
+#define IMG_SECTOR_SIZE         512
+#define IMG_PART_TYPE           0xDA           // "Non-FS data" partition type
+
+// Header byte offsets
+#define IMG_HDR_MAGIC           0    // 4 bytes
+#define IMG_HDR_VERSION         4    // 2 bytes
+#define IMG_HDR_FLAGS           6    // 2 bytes , IMG_FLAG_xxx
+#define IMG_HDR_LOAD            8    // 4 bytes , flash byte address of the first page
+#define IMG_HDR_LENGTH          12   // 4 bytes , binary length in bytes
+#define IMG_HDR_PAGES           16   // 2 bytes , number of flash pages to program
+#define IMG_HDR_PAGE_SIZE       18   // 2 bytes , page size the image was built for
+#define IMG_HDR_CRC             20   // 4 bytes , CRC-32 of the binary (length bytes)
+#define IMG_HDR_HDR_CRC         24   // 4 bytes , CRC-32 of header bytes 0..23
+#define IMG_HDR_SIZE            28
+
+// Header flags
+#define IMG_FLAG_IHEX           0x0001   // Payload is Intel HEX text of length bytes , CRC covers the text ,
+                                         // load and pages are not used (addresses come from the records)
+
+
+#endif /* IMGFMT_H_ */
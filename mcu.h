@@ -0,0 +1,43 @@
+/*
+ * mcu.h
+ *
+ * Created: 10/19/2026
+ *
+ * Target MCU profiles . Flash page size (SPM_PAGESIZE) and flash size
+ * (FLASHEND) come from the device header , a profile adds what avr-libc
+ * cannot know : the boot section start the bootloader is linked at
+ * (-Wl,--section-start=.text=MCU_BOOT_START , BOOTSZ fuses to match) .
+ *
+ *  MCU          page   boot section (largest)
+ *  ATmega32     128    0x7000   4 KB
+ *  ATmega644P   256    0xE000   8 KB
+ *  ATmega1284P  256    0x1E000  8 KB
+ */
+
+
+#ifndef MCU_H_
+#define MCU_H_
+
+#include <avr/io.h>
+
+/*========== Profiles ==========================*/
+
+#if defined(__AVR_ATmega32__)
+   #define MCU_NAME          "atmega32"
+   #define MCU_BOOT_START    0x7000UL
+#elif defined(__AVR_ATmega644P__)
+   #define MCU_NAME          "atmega644p"
+   #define MCU_BOOT_START    0xE000UL
+#elif defined(__AVR_ATmega1284P__)
+   #define MCU_NAME          "atmega1284p"
+   #define MCU_BOOT_START    0x1E000UL
+#else
+   #error "mcu.h : no profile for this MCU"
+#endif
+
+#if (MCU_BOOT_START % SPM_PAGESIZE) || (MCU_BOOT_START > FLASHEND)
+   #error "mcu.h : boot section start must be a page inside flash"
+#endif
+
+
+#endif /* MCU_H_ */
@@ -0,0 +1,140 @@
+/*
+ * prof.c
+ *
+ * Created: 10/19/2026
+ *
+ * Boot time profiler . Phase stamps are kept in Timer1 ticks (128 us at
+ * 8 MHz) since prof_start() , a phase that is never marked reads 0 ms .
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+
+#include "uart.h"
+#include "prof.h"
+#include "mcu.h"
+
+#ifdef PROF_SIMAVR
+   #include "avr_mcu_section.h"
+   AVR_MCU(F_CPU , MCU_NAME) ;
+#endif
+
+#define PROF_MAGIC   0x5046   // "FP" , marks a saved profile
+
+typedef struct
+{
+	uint16_t magic ;
+	uint32_t stamp[PROF_PHASES] ;   // Ticks since prof_start() at the end of each phase
+	uint16_t count[PROF_COUNTERS] ;
+}PROF_RECORD ;
+
+static PROF_RECORD prof ;
+static uint16_t overflows ;
+
+static const char phase_names[PROF_PHASES][8] PROGMEM = { "mount" , "locate" , "header" , "program" , "flush" , "verify" } ;
+static const char counter_names[PROF_COUNTERS][8] PROGMEM = { "retries" , "written" , "skipped" } ;
+
+static void print_P( const char *str )
+{
+	char ch ;
+
+	while( (ch = pgm_read_byte(str++)) )
+	   Uart_Transimit_chr(ch) ;
+}
+
+static void print_ms( uint32_t ticks )
+{
+	// us per tick , exact for F_CPU in whole kHz dividing 1024000 .
+	uint32_t ms = ticks * (PROF_PRESCALER * 1000UL / (F_CPU / 1000UL)) / 1000UL ;
+
+	Uart_Print_Int( (ms > 32767) ? 32767 : (int)ms ) ;
+}
+
+void prof_start(void)
+{
+	// Timer1 normal mode , clk/1024 , from 0 .
+	TCCR1B = 0 ;
+	TCCR1A = 0 ;
+	TCNT1 = 0 ;
+	TIFR1 = (1<<TOV1) ;
+	TCCR1B = (1<<CS12) | (1<<CS10) ;
+
+	overflows = 0 ;
+	for(uint8_t i = 0 ; i<PROF_PHASES ; i++) prof.stamp[i] = 0 ;
+	for(uint8_t i = 0 ; i<PROF_COUNTERS ; i++) prof.count[i] = 0 ;
+}
+
+uint32_t prof_now(void)
+{
+	uint16_t t = TCNT1 ;
+
+	// Overflow not counted yet , TCNT1 may have wrapped after it was read .
+	if(TIFR1 & (1<<TOV1))
+	{
+		TIFR1 = (1<<TOV1) ;
+		overflows++ ;
+		t = TCNT1 ;
+	}
+	return (uint32_t)overflows << 16 | t ;
+}
+
+void prof_mark( uint8_t phase )
+{
+	if(phase < PROF_PHASES)
+	   prof.stamp[phase] = prof_now() ;
+}
+
+void prof_count( uint8_t counter , uint16_t value )
+{
+	if(counter < PROF_COUNTERS)
+	   prof.count[counter] = value ;
+}
+
+void prof_stop(void)
+{
+	// Leave Timer1 as after reset for the application .
+	TCCR1B = 0 ;
+	TCNT1 = 0 ;
+	TIFR1 = (1<<TOV1) ;
+}
+
+void prof_report(void)
+{
+	// "mount 12 locate 3 ... ms , retries 0 written 3 skipped 221"
+	uint32_t prev = 0 ;
+
+	Uart_Transimit_String("\nBoot ms :") ;
+	for(uint8_t i = 0 ; i<PROF_PHASES ; i++)
+	{
+		uint32_t t = (prof.stamp[i] > prev) ? prof.stamp[i] : prev ;   // Not marked : 0 ms
+		Uart_Transimit_chr(' ') ;
+		print_P(phase_names[i]) ;
+		Uart_Transimit_chr(' ') ;
+		print_ms(t - prev) ;
+		prev = t ;
+	}
+	Uart_Transimit_String(" , total ") ;
+	print_ms(prev) ;
+	for(uint8_t i = 0 ; i<PROF_COUNTERS ; i++)
+	{
+		Uart_Transimit_chr(' ') ;
+		print_P(counter_names[i]) ;
+		Uart_Transimit_chr(' ') ;
+		Uart_Print_Int(prof.count[i]) ;
+	}
+}
+
+void prof_save(void)
+{
+	prof.magic = PROF_MAGIC ;
+	eeprom_update_block(&prof , (void *)PROF_EEADDR , sizeof(prof)) ;
+}
+
+uint8_t prof_load(void)
+{
+	// Profile saved by an earlier boot , for prof_report() . 0 if there is none .
+	eeprom_read_block(&prof , (const void *)PROF_EEADDR , sizeof(prof)) ;
+
+	return prof.magic == PROF_MAGIC ;
+}
@@ -5,20 +5,19 @@
  *  Author: Islam Gamal
  */ 
 
-#include <string.h>  // sprintf usage .
-
 #include <avr/delay.h> 
 
 #include "spi.h"
 #include "sd.h"
 #include "uart.h"
-
-#if (SD_DEBUG == ENABLE)
-uint8_t buffer[101] ;  // buffer for debug
-#endif
+#include "trace.h"
 
 int cmd_iterations = 0 ; 
 
+static SD_IDLE_HOOK idle_hook ;  // Called while waiting for and receiving sector data .
+static uint32_t read_count ;     // SD_Read_Sector() calls since SD_Clear_Counters()
+static uint16_t read_errors ;    // of them failed
+
 uint8_t SD_Send_Command(uint8_t command , uint32_t address) 
 {
 	
@@ -67,7 +66,7 @@ uint8_t SD_mount(void)
 	#endif	
 	
 	#if (SD_DEBUG == ENABLE)
-	    Uart_Transimit_String("\nmounting SD card...") ;
+	    Uart_Printf("\nmounting SD card...") ;
 	#endif   
 	
 	uint8_t response = 0xFF ;
@@ -85,27 +84,20 @@ uint8_t SD_mount(void)
 	 //3- Set SD card in SPI mode 
 	 
 	 #if (SD_DEBUG == ENABLE)
-		Uart_Transimit_String("\nTrying to put SD card in SPI mode...") ;
+		Uart_Printf("\nTrying to put SD card in SPI mode...") ;
 	#endif	
 	 
 	  assert_CS() ;
 	  response = SD_Send_Command(GO_IDLE_STATE , 0x00) ;
 		
 		#if (SD_DEBUG == ENABLE)
-		sprintf(buffer , "\nNo of iterations = %d" , cmd_iterations ) ;
-		Uart_Transimit_String(buffer) ;
-		
-		sprintf(buffer , "\nNo of attempts = %d" , attempts);
-		Uart_Transimit_String(buffer) ;
-		
-		sprintf(buffer , "\nResponse = 0x%X" , response) ;
-		Uart_Transimit_String(buffer) ;
+		Uart_Printf("\nNo of iterations = %d\nNo of attempts = %u\nResponse = 0x%02X" , cmd_iterations , attempts , response) ;
 		#endif
    }	
 	if( response != 0x01 )
 	{
 		#if (SD_DEBUG == ENABLE)
-		    Uart_Transimit_String("\nFailed to respond from SD card!!") ;
+		    Uart_Printf("\nFailed to respond from SD card!!") ;
 		#endif
 		
 		return 0xFF ; // Failed operation .
@@ -114,7 +106,7 @@ uint8_t SD_mount(void)
 	//4- Activates the cards initialization process.
 	
 	#if (SD_DEBUG == ENABLE)	
-		Uart_Transimit_String("\ninitialization process..") ;
+		Uart_Printf("\ninitialization process..") ;
 	#endif
 	
 	attempts = 0 ;
@@ -123,20 +115,13 @@ uint8_t SD_mount(void)
 		response = SD_Send_Command(SEND_OP_COND , 0x00) ;
 		
 		#if (SD_DEBUG == ENABLE)
-		sprintf(buffer , "\nNo of iterations = %d" , cmd_iterations ) ;
-		Uart_Transimit_String(buffer) ;
-		
-		sprintf(buffer , "\nNo of attempts = %d" , attempts);
-		Uart_Transimit_String(buffer) ;
-		
-		sprintf(buffer , "\nResponse = 0x%X" , response) ;
-		Uart_Transimit_String(buffer) ;
+		Uart_Printf("\nNo of iterations = %d\nNo of attempts = %u\nResponse = 0x%02X" , cmd_iterations , attempts , response) ;
 		#endif
 	}		
 	if( response != 0x00 )
 	{
 		#if (SD_DEBUG == ENABLE)
-		    Uart_Transimit_String("\nInitialization process Failed.!!") ;
+		    Uart_Printf("\nInitialization process Failed.!!") ;
 		#endif
 		
 		return 0xFF ; // Failed operation .
@@ -145,14 +130,14 @@ uint8_t SD_mount(void)
 	//5- Check if this card is SD or MMC .
 	
 	#if (SD_DEBUG == ENABLE)	
-		Uart_Transimit_String("\nChecking if it's SD (Not MMC)..") ;
+		Uart_Printf("\nChecking if it's SD (Not MMC)..") ;
 	#endif
 
 	response = SD_Send_Command(SD_APP_CMD , 0x00) ;
 	if( response != 0x00 )
 	{
 		#if (SD_DEBUG == ENABLE)
-		     Uart_Transimit_String("\nIts MMC NOT SD CARD !!\nMMC card mounted successfully") ;
+		     Uart_Printf("\nIts MMC NOT SD CARD !!\nMMC card mounted successfully") ;
 		#endif
 		de_assert_CS() ;
 		return 0x02 ; // 0x02 indicate that it's MMc card not SD card .
@@ -162,7 +147,7 @@ uint8_t SD_mount(void)
 	if( response != 0x00 )
 	{
 		#if (SD_DEBUG == ENABLE)
-		    Uart_Transimit_String("\nIts MMC NOT SD CARD !!\nMMC card mounted successfully") ;
+		    Uart_Printf("\nIts MMC NOT SD CARD !!\nMMC card mounted successfully") ;
 		#endif
 		de_assert_CS() ;
 		return 0x02 ; // 0x02 indicate that it's MMc card not SD card . 
@@ -170,7 +155,7 @@ uint8_t SD_mount(void)
 	
 	
 	#if (SD_DEBUG == ENABLE)	
-		Uart_Transimit_String("\nSD card mounted successfully") ;
+		Uart_Printf("\nSD card mounted successfully") ;
 	#endif
 	de_assert_CS() ;
 	
@@ -180,7 +165,7 @@ uint8_t SD_mount(void)
 uint8_t SD_unmount(void)
 {
 	#if (SD_DEBUG == ENABLE)	
-		Uart_Transimit_String("\nSD card unmounted.") ;
+		Uart_Printf("\nSD card unmounted.") ;
 	#endif
 	
 	de_assert_CS() ;
@@ -192,11 +177,17 @@ uint8_t SD_Read_Sector( uint32_t sector_offset , uint8_t *recv_buffer )
 {
 	// 1- Send command to SD/MMC card 
 	
+	TRACE(TRACE_SD_READ , sector_offset) ;
+	read_count++ ;
 	assert_CS() ;
 	uint8_t response = SD_Send_Command(SD_READ_SECTOR_CMD , ((uint32_t)sector_offset) << 9U) ;
 	
 	if(response != READ_RESPONSE_OK )
+	{
+	  TRACE(TRACE_SD_DONE , 0xFFFF) ;
+	  read_errors++ ;
 	  return response ;  // Read Failed
+	}
 	
 	// 2-Wait for data token response from SD card
       uint16_t i  ;
@@ -206,11 +197,13 @@ uint8_t SD_Read_Sector( uint32_t sector_offset , uint8_t *recv_buffer )
 		
 		if (response == 0xFE) 
 		   break ;  
+		if(idle_hook) idle_hook() ;
 	}
 	
 	if( response != 0xFE )
 	   {
-		 	
+		  TRACE(TRACE_SD_DONE , 0xFFFF) ;
+		  read_errors++ ;
 		  return 0xFF ;  // Means failed operation .
 	   }
 	   
@@ -219,6 +212,7 @@ uint8_t SD_Read_Sector( uint32_t sector_offset , uint8_t *recv_buffer )
 	   for( i = 0 ; i< SECTOR_SIZE ; i++ )
 	   {
 		   recv_buffer[i] = spi_read(0xFF) ;
+		   if(idle_hook && (i % SD_IDLE_INTERVAL) == SD_IDLE_INTERVAL - 1) idle_hook() ;
 	   }
 	   
 	   // 4-Receive 16-bit CRC and we can discard it 
@@ -231,6 +225,7 @@ uint8_t SD_Read_Sector( uint32_t sector_offset , uint8_t *recv_buffer )
 	   
 	   //6- De-assert chip
 	   de_assert_CS() ;
+	   TRACE(TRACE_SD_DONE , 0) ;
 	   
 	   return 0 ; // means no errors
 }
@@ -289,4 +284,51 @@ uint8_t SD_Write_Sector( uint32_t sector_offset , uint8_t *trans_buffer )
 	else
 	  return 0xFF ;   // Failed due to too long time wait .	
 }
-  
\ No newline at end of file
+  
+
+
+void SD_Set_Idle_Hook( SD_IDLE_HOOK hook )
+{
+	// Register work to run while SD_Read_Sector() waits on the card (NULL removes it) .
+	idle_hook = hook ;
+}
+
+uint32_t SD_Reads(void)
+{
+	// SD_Read_Sector() calls , failed ones included .
+	return read_count ;
+}
+
+uint16_t SD_Read_Errors(void)
+{
+	return read_errors ;
+}
+
+void SD_Clear_Counters(void)
+{
+	read_count = 0 ;
+	read_errors = 0 ;
+}
+
+
+uint8_t SD_Find_Partition( uint8_t type , uint8_t *buf , uint32_t *first_sector )
+{
+	// Search the MBR partition table for a partition of the given type , buf is a 512 byte work buffer .
+	if( SD_Read_Sector(0 , buf) != 0 )
+	   return 0xFF ;
+	if( buf[MBR_SIGNATURE] != 0x55 || buf[MBR_SIGNATURE+1] != 0xAA )
+	   return 0xFF ;  // Not partitioned
+	
+	for( uint8_t i = 0 ; i<MBR_PART_COUNT ; i++ )
+	{
+		const uint8_t *ent = buf + MBR_PART_TABLE + i*MBR_PART_ENTRY_SIZE ;
+		if( ent[MBR_PART_TYPE] == type )
+		{
+			*first_sector = ent[MBR_PART_LBA] | (uint32_t)ent[MBR_PART_LBA+1] << 8 |
+			                (uint32_t)ent[MBR_PART_LBA+2] << 16 | (uint32_t)ent[MBR_PART_LBA+3] << 24 ;
+			return 0 ;
+		}
+	}
+	
+	return 0xFF ;
+}
@@ -37,6 +37,15 @@
 #define WRITE_CRC_REJECTED      0x0B
 #define WRITE_ERROR_REJECTED    0x0D
 
+// Master boot record layout (sector 0)
+
+#define MBR_PART_TABLE          446
+#define MBR_PART_ENTRY_SIZE     16
+#define MBR_PART_COUNT          4
+#define MBR_PART_TYPE           4    // 1 byte , offset inside a partition entry
+#define MBR_PART_LBA            8    // 4 bytes , offset inside a partition entry
+#define MBR_SIGNATURE           510  // 2 bytes , 0x55 0xAA
+
 #define SD_CARD   0x01
 #define MMC_CARD  0x02
 
@@ -44,6 +53,12 @@
 #define DISABLE 0
 #define SD_DEBUG DISABLE
 
+#define SD_IDLE_INTERVAL 16   // Bytes received between two calls of the idle hook .
+
+/*========== Types ==========================*/
+
+typedef void (*SD_IDLE_HOOK)(void) ;  // Background work run while a sector is being read .
+
 /*========== Functions prototypes ==========================*/
 
 uint8_t SD_Send_Command(uint8_t command , uint32_t address) ;
@@ -51,6 +66,11 @@ uint8_t SD_mount(void) ;
 uint8_t SD_unmount(void) ;
 uint8_t SD_Read_Sector( uint32_t sector_offset , uint8_t *recv_buffer ) ;
 uint8_t SD_Write_Sector( uint32_t sector_offset , uint8_t *trans_buffer ) ;
+void SD_Set_Idle_Hook( SD_IDLE_HOOK hook ) ;
+uint32_t SD_Reads(void) ;
+uint16_t SD_Read_Errors(void) ;
+void SD_Clear_Counters(void) ;
+uint8_t SD_Find_Partition( uint8_t type , uint8_t *buf , uint32_t *first_sector ) ;
 
 
 
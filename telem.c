@@ -0,0 +1,119 @@
+/*
+ * telem.c
+ *
+ * Created: 10/19/2026
+ *
+ * Telemetry records , COBS encoded and queued in the UART transmit buffer .
+ * The frame is built in a TELEM_MAX_FRAME byte stack buffer and queued as
+ * one block , nothing else is kept besides the sequence number and the
+ * drop counter .
+ */
+
+#include "uart.h"
+#include "telem.h"
+
+static uint8_t seq ;
+static uint16_t dropped ;
+
+static void st16( uint8_t *p , uint16_t v )
+{
+	p[0] = v ;
+	p[1] = v >> 8 ;
+}
+
+static void st32( uint8_t *p , uint32_t v )
+{
+	p[0] = v ;
+	p[1] = v >> 8 ;
+	p[2] = v >> 16 ;
+	p[3] = v >> 24 ;
+}
+
+uint8_t telem_send( uint8_t type , const uint8_t *payload , uint8_t len )
+{
+	// 1 if the record was queued . Records < 254 bytes : one COBS block , one code byte .
+	uint8_t frame[TELEM_MAX_FRAME] ;
+	uint8_t n = 1 , code = 0 ;
+	uint16_t crc = 0xFFFF ;
+
+	if(len > TELEM_MAX_PAYLOAD)
+	   return 0 ;
+	if(Uart_Tx_Free() < len + 6)   // code , type , seq , payload , CRC , delimiter
+	{
+		dropped++ ;
+		seq++ ;   // The gap tells the decoder a record is missing .
+		return 0 ;
+	}
+
+	// 1- Raw record after the first COBS code byte .
+	frame[n++] = type ;
+	frame[n++] = seq++ ;
+	while(len--)
+	   frame[n++] = *payload++ ;
+	for(uint8_t i = 1 ; i<n ; i++)
+	   crc = telem_crc16(crc , frame[i]) ;
+	frame[n++] = crc ;
+	frame[n++] = crc >> 8 ;
+
+	// 2- COBS in place : each zero becomes the distance to the next one (or to the end) ,
+	//    counted from the code byte before it .
+	for(uint8_t i = 1 ; i<n ; i++)
+	{
+		if(!frame[i])
+		{
+			frame[code] = i - code ;
+			code = i ;
+		}
+	}
+	frame[code] = n - code ;
+	frame[n++] = 0 ;
+
+	put_TransBuffer_Block(frame , n) ;
+	return 1 ;
+}
+
+uint8_t telem_counter( uint8_t id , uint32_t value )
+{
+	uint8_t p[5] ;
+
+	p[0] = id ;
+	st32(p + 1 , value) ;
+	return telem_send(TELEM_COUNTER , p , sizeof(p)) ;
+}
+
+uint8_t telem_frame( uint16_t frame , uint16_t frame_us , uint16_t busy_us )
+{
+	uint8_t p[6] ;
+
+	st16(p , frame) ;
+	st16(p + 2 , frame_us) ;
+	st16(p + 4 , busy_us) ;
+	return telem_send(TELEM_FRAME , p , sizeof(p)) ;
+}
+
+uint8_t telem_sd( uint32_t sectors , uint16_t errors , uint16_t read_us )
+{
+	uint8_t p[8] ;
+
+	st32(p , sectors) ;
+	st16(p + 4 , errors) ;
+	st16(p + 6 , read_us) ;
+	return telem_send(TELEM_SD , p , sizeof(p)) ;
+}
+
+uint8_t telem_event( uint16_t id , const uint8_t *data , uint8_t len )
+{
+	uint8_t p[TELEM_MAX_PAYLOAD] ;
+
+	if(len > TELEM_MAX_PAYLOAD - 2)
+	   return 0 ;
+	st16(p , id) ;
+	for(uint8_t i = 0 ; i<len ; i++)
+	   p[2 + i] = data[i] ;
+	return telem_send(TELEM_EVENT , p , len + 2) ;
+}
+
+uint16_t telem_dropped(void)
+{
+	return dropped ;
+}
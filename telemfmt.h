@@ -0,0 +1,59 @@
+/*
+ * telemfmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * Binary telemetry stream . Shared by telem.c and tools/telemdec.c .
+ *
+ *  record : type , seq , payload (0 .. TELEM_MAX_PAYLOAD bytes) , CRC (2 bytes)
+ *  frame  : COBS encoded record , then 0x00
+ *
+ * COBS removes every 0x00 from the record , so 0x00 only ends frames and a
+ * receiver joining mid-stream (or after a lost byte) resyncs at the next
+ * one . CRC is CRC-16/CCITT (poly 0x1021 , init 0xFFFF , not reflected) over
+ * type , seq and payload . seq counts records , a gap means records were
+ * dropped on the device (TX buffer full) or on the line .
+ *
+ * Payloads
+ *  COUNTER : id (1) , value (4)
+ *  FRAME   : frame number (2) , frame time in us (2) , busy time in us (2)
+ *  SD      : sectors read (4) , read errors (2) , last read time in us (2)
+ *  EVENT   : id (2) , 0 .. TELEM_MAX_PAYLOAD - 2 data bytes
+ *  TRACE   : tick length in ns (4) , then 1 .. 5 trace events oldest first :
+ *            id (1) , Timer1 stamp (2) , arg (2)   (see trace.h)
+ *
+ * All multi-byte fields are little-endian .
+ */
+
+
+#ifndef TELEMFMT_H_
+#define TELEMFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#define TELEM_MAX_PAYLOAD       32
+#define TELEM_MAX_RECORD        (2 + TELEM_MAX_PAYLOAD + 2)
+#define TELEM_MAX_FRAME         (TELEM_MAX_RECORD + 2)   // COBS code byte + delimiter , records are < 254 bytes
+
+// Record types
+#define TELEM_COUNTER           0x01
+#define TELEM_FRAME             0x02
+#define TELEM_SD                0x03
+#define TELEM_EVENT             0x04
+#define TELEM_TRACE             0x05
+
+/*========== Functions ==========================*/
+
+// CRC-16/CCITT of one byte , same as avr-libc _crc_xmodem_update() with init 0xFFFF .
+static inline uint16_t telem_crc16(uint16_t crc , uint8_t data)
+{
+	crc ^= (uint16_t)data << 8 ;
+	for(uint8_t i = 0 ; i<8 ; i++)
+	   crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1 ;
+	return crc ;
+}
+
+
+#endif /* TELEMFMT_H_ */
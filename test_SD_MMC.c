@@ -10,12 +10,25 @@
 #include <string.h>
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 
 
 #include "sd.h"
 #include "uart.h"
+#include "console.h"
+
+uint8_t Rbuffer[512] ;
+
+static void bench_sd_read(void)
+{
+	SD_Read_Sector(0 , Rbuffer) ;
+}
+
+// Run from the console : "bench sd_read 100" .
+static const CONSOLE_BENCH benches[] PROGMEM = {
+	{ "sd_read" , bench_sd_read } ,
+} ;
 
-uint8_t buffer[50] ;
 int main(void)
 {
 	
@@ -26,10 +39,12 @@ int main(void)
 	PORTA = 0xFF ;
 	DDRC = 0xFF ;
    Uart_init(9600) ;
+   Uart_Set_Tx_Timeout(10) ;  // Uart_Printf() waits for room instead of dropping output .
    mount = SD_mount() ;
   
   uint8_t Tbuffer[512] ;
-  uint8_t Rbuffer[512] ;
+  
+  console_init(benches , sizeof(benches) / sizeof(benches[0]) , Rbuffer) ;
   
   for(int i = 0 ; i<256 ; i++)
   {
@@ -38,6 +53,8 @@ int main(void)
 
   while(1)
   {
+	 console_poll() ;
+	 
 	 if( !(PINA & (1<<PA0) ) && (mount == SD_CARD || mount == MMC_CARD ) )
 	 {
 		 SD_Write_Sector(0 , Tbuffer) ;
@@ -52,8 +69,7 @@ int main(void)
 	 {
 		 SD_Read_Sector(0 ,Rbuffer ) ;
 		 
-		 sprintf(buffer , "\nData in file is 0x%X", Rbuffer[0x05]) ;
-		 Uart_Transimit_String(buffer) ;
+		 Uart_Printf("\nData in file is 0x%X", Rbuffer[0x05]) ;
 		 
 		  while( !(PINA & (1<<PA1) ) ) ;
 	 }//if
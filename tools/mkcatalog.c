@@ -0,0 +1,331 @@
+/*
+ * mkcatalog.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : build the game catalog (see FAT16_bootloader/catfmt.h) from
+ * the games already copied to the card .
+ *
+ *   mkcatalog card out.dat [NAME.BIN=title[@thumb]] ...
+ *
+ *   card  : image file or raw device of the card (a whole card with a
+ *           partition table or a single FAT volume)
+ *   title : menu title of NAME.BIN , the file name otherwise
+ *   thumb : byte offset of the thumbnail inside NAME.BIN
+ *
+ * Build : gcc -O2 -o mkcatalog mkcatalog.c
+ *
+ * Every file of the "files" directory gets a record in directory order .
+ * Copy out.dat to the card root as CATALOG.DAT , copying it does not move
+ * the games . Rebuild it after any other change to the "files" directory .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../FAT16_bootloader/catfmt.h"
+
+#define SECTOR_SIZE   512
+#define DIR_NAME      "FILES      "   // 8.3 directory entry form of "files"
+#define MAX_GAMES     0xFFFF
+
+typedef struct
+{
+	char name[13] ;
+	const char *title ;
+	uint32_t thumb ;
+}TITLE_IN ;
+
+static FILE *card ;
+static uint32_t vol_base , fat_base , root_base , data_base , root_clust ;
+static uint32_t n_rootdir , csize , n_clust ;
+static int fat32 ;
+
+static uint16_t ld16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 ;
+}
+
+static uint32_t ld32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24 ;
+}
+
+static void put16(uint8_t *p , uint16_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ;
+}
+
+static void put32(uint8_t *p , uint32_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ; p[2] = v >> 16 ; p[3] = v >> 24 ;
+}
+
+static void read_sector(uint32_t sect , uint8_t *buf)
+{
+	if(fseek(card , (long)sect * SECTOR_SIZE , SEEK_SET) || fread(buf , 1 , SECTOR_SIZE , card) != SECTOR_SIZE)
+	{
+		fprintf(stderr , "mkcatalog: can't read sector %lu\n" , (unsigned long)sect) ;
+		exit(1) ;
+	}
+}
+
+static uint32_t next_clust(uint32_t clst)
+{
+	uint8_t buf[SECTOR_SIZE] ;
+	uint32_t ofs = fat32 ? clst * 4 : clst * 2 ;
+
+	read_sector(fat_base + ofs / SECTOR_SIZE , buf) ;
+	return fat32 ? ld32(buf + ofs % SECTOR_SIZE) & 0x0FFFFFFF : ld16(buf + ofs % SECTOR_SIZE) ;
+}
+
+static int valid_clust(uint32_t clst)
+{
+	return clst >= 2 && clst < n_clust + 2 ;
+}
+
+static int is_fat(const uint8_t *bs)
+{
+	return ld16(bs + 510) == 0xAA55 && (bs[0] == 0xEB || bs[0] == 0xE9) && ld16(bs + 11) == SECTOR_SIZE && bs[13] ;
+}
+
+static void mount(void)
+{
+	// 1- Whole card : first partition , single volume : sector 0 .
+	uint8_t bs[SECTOR_SIZE] ;
+
+	read_sector(0 , bs) ;
+	if(!is_fat(bs))
+	{
+		vol_base = ld32(bs + 446 + 8) ;
+		read_sector(vol_base , bs) ;
+		if(!is_fat(bs))
+		{
+			fprintf(stderr , "mkcatalog: no FAT volume found\n") ;
+			exit(1) ;
+		}
+	}
+
+	// 2- Volume layout , same rules as pf_mount() .
+	uint32_t fsize = ld16(bs + 22) ? ld16(bs + 22) : ld32(bs + 36) ;
+	uint32_t tsect = ld16(bs + 19) ? ld16(bs + 19) : ld32(bs + 32) ;
+
+	csize = bs[13] ;
+	n_rootdir = ld16(bs + 17) ;
+	fat_base = vol_base + ld16(bs + 14) ;
+	root_base = fat_base + fsize * bs[16] ;
+	data_base = root_base + n_rootdir / 16 ;
+	n_clust = (tsect - (data_base - vol_base)) / csize ;
+	if(n_clust < 4085)
+	{
+		fprintf(stderr , "mkcatalog: FAT12 volumes are not supported\n") ;
+		exit(1) ;
+	}
+	fat32 = n_clust >= 65525 ;
+	root_clust = fat32 ? ld32(bs + 44) : 0 ;
+}
+
+// Calls func for every 32 byte entry of a directory until it returns non zero .
+static int walk_dir(uint32_t clst , int (*func)(const uint8_t *ent , void *arg) , void *arg)
+{
+	uint8_t buf[SECTOR_SIZE] ;
+
+	if(!clst)
+	{
+		// FAT16 root directory , fixed region .
+		for(uint32_t s = 0 ; s < n_rootdir / 16 ; s++)
+		{
+			read_sector(root_base + s , buf) ;
+			for(int e = 0 ; e < SECTOR_SIZE ; e += 32)
+			   if(func(buf + e , arg)) return 1 ;
+		}
+		return 0 ;
+	}
+	while(valid_clust(clst))
+	{
+		for(uint32_t s = 0 ; s < csize ; s++)
+		{
+			read_sector(data_base + (clst - 2) * csize + s , buf) ;
+			for(int e = 0 ; e < SECTOR_SIZE ; e += 32)
+			   if(func(buf + e , arg)) return 1 ;
+		}
+		clst = next_clust(clst) ;
+	}
+	return 0 ;
+}
+
+static uint32_t ent_clust(const uint8_t *ent)
+{
+	return (fat32 ? (uint32_t)ld16(ent + 20) << 16 : 0) | ld16(ent + 26) ;
+}
+
+static int find_files_dir(const uint8_t *ent , void *arg)
+{
+	if(!ent[0]) return 1 ;   // End of directory
+	if((ent[11] & 0x10) && ent[11] != 0x0F && !memcmp(ent , DIR_NAME , 11))
+	{
+		*(uint32_t*)arg = ent_clust(ent) ;
+		return 1 ;
+	}
+	return 0 ;
+}
+
+static uint32_t crc32_update(uint32_t crc , const uint8_t *data , uint32_t len)
+{
+	while(len--)
+	{
+		crc ^= *data++ ;
+		for(int b = 0 ; b<8 ; b++)
+		   crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1)) ;
+	}
+	return crc ;
+}
+
+static uint32_t file_crc(uint32_t clst , uint32_t size)
+{
+	// Follow the cluster chain the way the launcher will .
+	uint8_t buf[SECTOR_SIZE] ;
+	uint32_t crc = 0xFFFFFFFFUL ;
+
+	while(size)
+	{
+		if(!valid_clust(clst))
+		{
+			fprintf(stderr , "mkcatalog: broken cluster chain\n") ;
+			exit(1) ;
+		}
+		for(uint32_t s = 0 ; s < csize && size ; s++)
+		{
+			uint32_t n = size < SECTOR_SIZE ? size : SECTOR_SIZE ;
+			read_sector(data_base + (clst - 2) * csize + s , buf) ;
+			crc = crc32_update(crc , buf , n) ;
+			size -= n ;
+		}
+		clst = next_clust(clst) ;
+	}
+	return ~crc ;
+}
+
+static TITLE_IN *titles ;
+static int n_titles ;
+static uint8_t *out ;
+static uint32_t count ;
+
+static int add_game(const uint8_t *ent , void *arg)
+{
+	(void)arg ;
+	if(!ent[0]) return 1 ;   // End of directory
+	if(ent[0] == 0xE5 || ent[11] == 0x0F || (ent[11] & 0x18)) return 0 ;   // Deleted , LFN , directory or label
+	if(count == MAX_GAMES)
+	{
+		fprintf(stderr , "mkcatalog: too many games\n") ;
+		exit(1) ;
+	}
+
+	// 8.3 entry name to "NAME.EXT" .
+	char name[13] ;
+	int n = 0 ;
+	for(int i = 0 ; i<8 && ent[i] != ' ' ; i++) name[n++] = ent[i] ;
+	if(ent[8] != ' ')
+	{
+		name[n++] = '.' ;
+		for(int i = 8 ; i<11 && ent[i] != ' ' ; i++) name[n++] = ent[i] ;
+	}
+	name[n] = '\0' ;
+
+	const char *title = name ;
+	uint32_t thumb = 0 ;
+	for(int i = 0 ; i<n_titles ; i++)
+	   if(!strcmp(titles[i].name , name))
+	   {
+		   title = titles[i].title ;
+		   thumb = titles[i].thumb ;
+	   }
+
+	uint32_t clst = ent_clust(ent) , size = ld32(ent + 28) ;
+	uint8_t *rec ;
+
+	count++ ;
+	out = realloc(out , (count + 1) * CAT_REC_SIZE) ;
+	rec = out + count * CAT_REC_SIZE ;
+	memset(rec , 0 , CAT_REC_SIZE) ;
+	strncpy((char*)rec + CAT_ENT_TITLE , title , CAT_TITLE_SIZE - 1) ;
+	strncpy((char*)rec + CAT_ENT_NAME , name , CAT_NAME_SIZE - 1) ;
+	put32(rec + CAT_ENT_CLUST , clst) ;
+	put32(rec + CAT_ENT_SIZE , size) ;
+	put32(rec + CAT_ENT_CRC , file_crc(clst , size)) ;
+	put32(rec + CAT_ENT_THUMB , thumb) ;
+	if(thumb >= size && thumb)
+	   fprintf(stderr , "mkcatalog: warning , thumbnail of %s is past its end\n" , name) ;
+
+	printf("%3lu  %-12s %8lu  %s\n" , (unsigned long)count - 1 , name , (unsigned long)size , title) ;
+	return 0 ;
+}
+
+int main(int argc , char **argv)
+{
+	if(argc < 3)
+	{
+		fprintf(stderr , "usage: mkcatalog card out.dat [NAME.BIN=title[@thumb]] ...\n") ;
+		return 1 ;
+	}
+
+	// 1- Titles from the command line , names are matched in upper case like 8.3 entries .
+	titles = calloc(argc , sizeof(TITLE_IN)) ;
+	for(int i = 3 ; i<argc ; i++)
+	{
+		char *eq = strchr(argv[i] , '=') , *at ;
+		if(!eq || eq - argv[i] > 12)
+		{
+			fprintf(stderr , "mkcatalog: expected NAME.BIN=title , got %s\n" , argv[i]) ;
+			return 1 ;
+		}
+		*eq = '\0' ;
+		for(int c = 0 ; argv[i][c] ; c++) titles[n_titles].name[c] = toupper((unsigned char)argv[i][c]) ;
+		titles[n_titles].title = eq + 1 ;
+		if( (at = strrchr(eq + 1 , '@')) )
+		{
+			*at = '\0' ;
+			titles[n_titles].thumb = strtoul(at + 1 , NULL , 0) ;
+		}
+		n_titles++ ;
+	}
+
+	// 2- Find "files" in the root directory and catalog its files .
+	card = fopen(argv[1] , "rb") ;
+	if(!card)
+	{
+		perror(argv[1]) ;
+		return 1 ;
+	}
+	mount() ;
+
+	uint32_t dir_clust = 0xFFFFFFFFUL ;
+	walk_dir(root_clust , find_files_dir , &dir_clust) ;
+	if(!valid_clust(dir_clust))
+	{
+		fprintf(stderr , "mkcatalog: no \"files\" directory\n") ;
+		return 1 ;
+	}
+	out = calloc(1 , CAT_REC_SIZE) ;
+	walk_dir(dir_clust , add_game , NULL) ;
+	fclose(card) ;
+
+	// 3- Header record .
+	put32(out + CAT_HDR_MAGIC , CAT_MAGIC) ;
+	put16(out + CAT_HDR_VERSION , CAT_VERSION) ;
+	put16(out + CAT_HDR_COUNT , (uint16_t)count) ;
+
+	FILE *f = fopen(argv[2] , "wb") ;
+	if(!f || fwrite(out , CAT_REC_SIZE , count + 1 , f) != count + 1)
+	{
+		perror(argv[2]) ;
+		return 1 ;
+	}
+	fclose(f) ;
+
+	printf("%s : %lu games\n" , argv[2] , (unsigned long)count) ;
+	return 0 ;
+}
@@ -0,0 +1,227 @@
+/*
+ * mkdelta.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : build a delta patch that turns the flashed old.bin into
+ * new.bin (see FAT16_bootloader/deltafmt.h) .
+ *
+ *   mkdelta [-p page_size] old.bin new.bin out.dlt
+ *
+ *   -p : device flash page size in bytes (default 256 , ATmega644P)
+ *
+ * Build : gcc -O2 -o mkdelta mkdelta.c
+ *
+ * Copy the patch to the card as files/<name>.bin , the FAT16 bootloader
+ * detects patches by their magic number and refuses them when the flash
+ * does not hold old.bin .
+ *
+ * Patches are applied in place , so code moved to a higher address can only
+ * be copied within one page and is mostly sent as new bytes . Keep sections
+ * at fixed addresses between releases for small patches .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../FAT16_bootloader/deltafmt.h"
+
+#define MIN_COPY     8        // Shorter matches cost more as COPY (6 bytes) than inline .
+#define MAX_COPY     0xFFFF
+#define MAX_INSERT   0xFFFF
+#define HASH_BITS    16
+#define MAX_CHAIN    256      // Candidates tried per position .
+
+static void put16(uint8_t *p , uint16_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ;
+}
+
+static void put32(uint8_t *p , uint32_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ; p[2] = v >> 16 ; p[3] = v >> 24 ;
+}
+
+static uint32_t crc32(const uint8_t *data , long len)
+{
+	uint32_t crc = 0xFFFFFFFFUL ;
+
+	while(len--)
+	{
+		crc ^= *data++ ;
+		for(int b = 0 ; b<8 ; b++)
+		   crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1)) ;
+	}
+	return ~crc ;
+}
+
+static uint8_t *load(const char *path , long *len)
+{
+	FILE *f = fopen(path , "rb") ;
+	uint8_t *data ;
+
+	if(!f) return NULL ;
+	fseek(f , 0 , SEEK_END) ;
+	*len = ftell(f) ;
+	rewind(f) ;
+	data = malloc(*len + 1) ;
+	if(fread(data , 1 , *len , f) != (size_t)*len)
+	{
+		fclose(f) ;
+		free(data) ;
+		return NULL ;
+	}
+	fclose(f) ;
+	return data ;
+}
+
+static uint32_t hash4(const uint8_t *p)
+{
+	return (uint32_t)((p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24) * 2654435761UL) >> (32 - HASH_BITS) ;
+}
+
+static long match(const uint8_t *a , long a_len , const uint8_t *b , long b_len)
+{
+	long n = 0 , max = a_len < b_len ? a_len : b_len ;
+
+	if(max > MAX_COPY) max = MAX_COPY ;
+	while(n < max && a[n] == b[n]) n++ ;
+	return n ;
+}
+
+static uint8_t *out ;
+static long out_len , ins_start = -1 ;
+static long n_copy , n_insert , copied , inserted ;
+
+static void flush_insert(const uint8_t *new_bin , long pos)
+{
+	// Emit the pending literal run [ins_start , pos) .
+	while(ins_start >= 0 && ins_start < pos)
+	{
+		long n = pos - ins_start ;
+		if(n > MAX_INSERT) n = MAX_INSERT ;
+		out[out_len++] = DELTA_OP_INSERT ;
+		put16(out + out_len , (uint16_t)n) ;
+		out_len += 2 ;
+		memcpy(out + out_len , new_bin + ins_start , n) ;
+		out_len += n ;
+		ins_start += n ;
+		n_insert++ ;
+		inserted += n ;
+	}
+	ins_start = -1 ;
+}
+
+int main(int argc , char **argv)
+{
+	unsigned long page_size = 256 ;
+	const char *path[3] ;
+	int n_path = 0 ;
+
+	for(int i = 1 ; i<argc ; i++)
+	{
+		if(!strcmp(argv[i] , "-p") && i+1 < argc)
+		   page_size = strtoul(argv[++i] , NULL , 0) ;
+		else if(n_path < 3)
+		   path[n_path++] = argv[i] ;
+	}
+	if(n_path != 3 || !page_size || (page_size & (page_size - 1)))
+	{
+		fprintf(stderr , "usage: mkdelta [-p page_size] old.bin new.bin out.dlt\n") ;
+		return 1 ;
+	}
+
+	long old_len , new_len ;
+	uint8_t *old_bin = load(path[0] , &old_len) , *new_bin = load(path[1] , &new_len) ;
+	if(!old_bin || !new_bin)
+	{
+		perror(old_bin ? path[1] : path[0]) ;
+		return 1 ;
+	}
+
+	// 1- Hash chains over every 4 byte sequence of the old image , newest first .
+	long *head = malloc(sizeof(long) << HASH_BITS) , *next = malloc(sizeof(long) * (old_len + 1)) ;
+	for(long i = 0 ; i < (1L << HASH_BITS) ; i++) head[i] = -1 ;
+	for(long i = 0 ; i + 4 <= old_len ; i++)
+	{
+		uint32_t h = hash4(old_bin + i) ;
+		next[i] = head[h] ;
+		head[h] = i ;
+	}
+
+	// 2- Greedy : longest copy whose source has not been rewritten yet , literals otherwise .
+	out = malloc(DELTA_HDR_SIZE + new_len * 2 + 16) ;
+	out_len = DELTA_HDR_SIZE ;
+
+	for(long pos = 0 ; pos < new_len ; )
+	{
+		long page_start = pos & ~(long)(page_size - 1) ;
+		long best_len = 0 , best_src = 0 ;
+
+		// Same address first , the common case for a patched image .
+		if(pos < old_len)
+		{
+			best_len = match(old_bin + pos , old_len - pos , new_bin + pos , new_len - pos) ;
+			best_src = pos ;
+		}
+		if(best_len < MAX_COPY && pos + 4 <= new_len)
+		{
+			int chain = 0 ;
+			for(long s = head[hash4(new_bin + pos)] ; s >= 0 && chain < MAX_CHAIN ; s = next[s] , chain++)
+			{
+				// Source behind the destination : only until the end of this page , the
+				// next page overwrites the flash the rest of the copy would read .
+				if(s < page_start) continue ;
+				long room = (s < pos) ? page_start + (long)page_size - pos : new_len - pos ;
+				if(room > new_len - pos) room = new_len - pos ;
+				long l = match(old_bin + s , old_len - s , new_bin + pos , room) ;
+				if(l > best_len)
+				{
+					best_len = l ;
+					best_src = s ;
+				}
+			}
+		}
+
+		if(best_len >= MIN_COPY)
+		{
+			flush_insert(new_bin , pos) ;
+			out[out_len++] = DELTA_OP_COPY ;
+			out[out_len++] = best_src ;
+			out[out_len++] = best_src >> 8 ;
+			out[out_len++] = best_src >> 16 ;
+			put16(out + out_len , (uint16_t)best_len) ;
+			out_len += 2 ;
+			pos += best_len ;
+			n_copy++ ;
+			copied += best_len ;
+		}
+		else
+		{
+			if(ins_start < 0) ins_start = pos ;
+			pos++ ;
+		}
+	}
+	flush_insert(new_bin , new_len) ;
+	out[out_len++] = DELTA_OP_END ;
+
+	// 3- Header .
+	put32(out + DELTA_HDR_MAGIC , DELTA_MAGIC) ;
+	put32(out + DELTA_HDR_BASE_LENGTH , (uint32_t)old_len) ;
+	put32(out + DELTA_HDR_BASE_CRC , crc32(old_bin , old_len)) ;
+	put32(out + DELTA_HDR_LENGTH , (uint32_t)new_len) ;
+	put32(out + DELTA_HDR_CRC , crc32(new_bin , new_len)) ;
+
+	FILE *f = fopen(path[2] , "wb") ;
+	if(!f || fwrite(out , 1 , out_len , f) != (size_t)out_len)
+	{
+		perror(path[2]) ;
+		return 1 ;
+	}
+	fclose(f) ;
+
+	printf("%s : %ld bytes , %ld copies (%ld bytes) , %ld inserts (%ld bytes)\n" , path[2] , out_len ,
+	       n_copy , copied , n_insert , inserted) ;
+	return 0 ;
+}
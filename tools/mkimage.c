@@ -0,0 +1,132 @@
+/*
+ * mkimage.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : wrap an application .bin with the header read by SD_Bootloader.c
+ * (see imgfmt.h) .
+ *
+ *   mkimage [-l load_address] [-p page_size] app.bin out.img
+ *   mkimage -x [-p page_size] app.hex out.img
+ *
+ *   -l : flash byte address of the first page (default 0x0000)
+ *   -p : device flash page size in bytes (default 256 , ATmega644P)
+ *   -x : input is Intel HEX , stored as text and parsed by the bootloader
+ *
+ * Build : gcc -O2 -o mkimage mkimage.c
+ *
+ * Write the output raw at the start of a partition of type 0xDA , e.g. on
+ * Linux : fdisk (type da) then dd if=out.img of=/dev/sdX2 .
+ * For the FAT16 bootloader copy it as a normal file into files/ instead .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../imgfmt.h"
+
+static void put16(uint8_t *p , uint16_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ;
+}
+
+static void put32(uint8_t *p , uint32_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ; p[2] = v >> 16 ; p[3] = v >> 24 ;
+}
+
+static uint32_t crc32(const uint8_t *data , long len)
+{
+	uint32_t crc = 0xFFFFFFFFUL ;
+
+	while(len--)
+	{
+		crc ^= *data++ ;
+		for(int b = 0 ; b<8 ; b++)
+		   crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1)) ;
+	}
+	return ~crc ;
+}
+
+int main(int argc , char **argv)
+{
+	uint32_t load = 0 ;
+	unsigned long page_size = 256 ;
+	const char *in_path = NULL , *out_path = NULL ;
+	int ihex = 0 ;
+
+	// 1- Parse command line .
+	for(int i = 1 ; i<argc ; i++)
+	{
+		if(!strcmp(argv[i] , "-l") && i+1 < argc)
+		   load = strtoul(argv[++i] , NULL , 0) ;
+		else if(!strcmp(argv[i] , "-p") && i+1 < argc)
+		   page_size = strtoul(argv[++i] , NULL , 0) ;
+		else if(!strcmp(argv[i] , "-x"))
+		   ihex = 1 ;
+		else if(!in_path)
+		   in_path = argv[i] ;
+		else
+		   out_path = argv[i] ;
+	}
+	if(!in_path || !out_path || !page_size || page_size > IMG_SECTOR_SIZE || (load % page_size))
+	{
+		fprintf(stderr , "usage: mkimage [-l load_address] [-p page_size] app.bin out.img\n"
+		                 "       mkimage -x [-p page_size] app.hex out.img\n") ;
+		return 1 ;
+	}
+
+	// 2- Load the binary and pad it with 0xFF (erased flash) to a whole page and sector .
+	//    A HEX file is kept as text , pages and load address come from its records .
+	FILE *in = fopen(in_path , "rb") ;
+	if(!in)
+	{
+		perror(in_path) ;
+		return 1 ;
+	}
+	fseek(in , 0 , SEEK_END) ;
+	long len = ftell(in) ;
+	rewind(in) ;
+
+	uint32_t pages = ihex ? 0 : (len + page_size - 1) / page_size ;
+	if(ihex) load = 0 ;
+	long padded = (((ihex ? len : (long)(pages * page_size)) + IMG_SECTOR_SIZE - 1) / IMG_SECTOR_SIZE) * IMG_SECTOR_SIZE ;
+	uint8_t *bin = malloc(padded + 1) ;
+	memset(bin , 0xFF , padded + 1) ;
+	if(fread(bin , 1 , len , in) != (size_t)len)
+	{
+		perror(in_path) ;
+		return 1 ;
+	}
+	fclose(in) ;
+	if(pages > 0xFFFF)
+	{
+		fprintf(stderr , "mkimage: binary too large\n") ;
+		return 1 ;
+	}
+
+	// 3- Header sector .
+	uint8_t hdr[IMG_SECTOR_SIZE] = {0} ;
+	put32(hdr + IMG_HDR_MAGIC , IMG_MAGIC) ;
+	put16(hdr + IMG_HDR_VERSION , IMG_VERSION) ;
+	put16(hdr + IMG_HDR_FLAGS , ihex ? IMG_FLAG_IHEX : 0) ;
+	put32(hdr + IMG_HDR_LOAD , load) ;
+	put32(hdr + IMG_HDR_LENGTH , (uint32_t)len) ;
+	put16(hdr + IMG_HDR_PAGES , (uint16_t)pages) ;
+	put16(hdr + IMG_HDR_PAGE_SIZE , (uint16_t)page_size) ;
+	put32(hdr + IMG_HDR_CRC , crc32(bin , len)) ;
+	put32(hdr + IMG_HDR_HDR_CRC , crc32(hdr , IMG_HDR_HDR_CRC)) ;
+
+	FILE *out = fopen(out_path , "wb") ;
+	if(!out || fwrite(hdr , 1 , sizeof(hdr) , out) != sizeof(hdr) || fwrite(bin , 1 , padded , out) != (size_t)padded)
+	{
+		perror(out_path) ;
+		return 1 ;
+	}
+	fclose(out) ;
+
+	printf("%s : %ld bytes , %lu pages of %lu at 0x%05lX , crc 0x%08lX\n" , in_path , len , (unsigned long)pages ,
+	       page_size , (unsigned long)load , (unsigned long)crc32(bin , len)) ;
+	return 0 ;
+}
@@ -0,0 +1,128 @@
+/*
+ * mklz.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : compress an application .bin for the FAT16 bootloader
+ * (see FAT16_bootloader/lzfmt.h) .
+ *
+ *   mklz app.bin app.lz
+ *
+ * Build : gcc -O2 -o mklz mklz.c
+ *
+ * Copy the output to the card as files/<name>.bin , the bootloader detects
+ * compressed images by their magic number .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../FAT16_bootloader/lzfmt.h"
+
+static void put32(uint8_t *p , uint32_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ; p[2] = v >> 16 ; p[3] = v >> 24 ;
+}
+
+static uint8_t *load(const char *path , long *len)
+{
+	FILE *f = fopen(path , "rb") ;
+	uint8_t *data ;
+
+	if(!f) return NULL ;
+	fseek(f , 0 , SEEK_END) ;
+	*len = ftell(f) ;
+	rewind(f) ;
+	data = malloc(*len + 1) ;
+	if(fread(data , 1 , *len , f) != (size_t)*len)
+	{
+		fclose(f) ;
+		free(data) ;
+		return NULL ;
+	}
+	fclose(f) ;
+	return data ;
+}
+
+static long compress(const uint8_t *in , long len , uint8_t *out)
+{
+	// Greedy longest match within the last LZ_WINDOW_SIZE bytes .
+	long pos = 0 , o = 0 , flag_pos = 0 ;
+	int items = 8 ;
+
+	while(pos < len)
+	{
+		if(items == 8)
+		{
+			flag_pos = o++ ;
+			out[flag_pos] = 0 ;
+			items = 0 ;
+		}
+
+		int best_len = 0 , best_dist = 0 ;
+		long start = pos > LZ_WINDOW_SIZE ? pos - LZ_WINDOW_SIZE : 0 ;
+		for(long s = pos - 1 ; s >= start ; s--)
+		{
+			int l = 0 ;
+			while(l < LZ_MAX_MATCH && pos + l < len && in[s + l] == in[pos + l]) l++ ;
+			if(l > best_len)
+			{
+				best_len = l ;
+				best_dist = (int)(pos - s) ;
+				if(l == LZ_MAX_MATCH) break ;
+			}
+		}
+
+		if(best_len >= LZ_MIN_MATCH)
+		{
+			out[o++] = (uint8_t)(best_dist - 1) ;
+			out[o++] = (uint8_t)(best_len - LZ_MIN_MATCH) ;
+			pos += best_len ;
+		}
+		else
+		{
+			out[flag_pos] |= 1 << items ;
+			out[o++] = in[pos++] ;
+		}
+		items++ ;
+	}
+
+	return o ;
+}
+
+int main(int argc , char **argv)
+{
+	long len ;
+	uint8_t *in ;
+
+	if(argc != 3)
+	{
+		fprintf(stderr , "usage: mklz app.bin app.lz\n") ;
+		return 1 ;
+	}
+
+	in = load(argv[1] , &len) ;
+	if(!in)
+	{
+		perror(argv[1]) ;
+		return 1 ;
+	}
+
+	// Worst case : every item is a literal , plus one flag byte per 8 items .
+	uint8_t *out = malloc(LZ_HDR_SIZE + len + len / 8 + 1) ;
+	put32(out + LZ_HDR_MAGIC , LZ_MAGIC) ;
+	put32(out + LZ_HDR_LENGTH , (uint32_t)len) ;
+	long olen = LZ_HDR_SIZE + compress(in , len , out + LZ_HDR_SIZE) ;
+
+	FILE *f = fopen(argv[2] , "wb") ;
+	if(!f || fwrite(out , 1 , olen , f) != (size_t)olen)
+	{
+		perror(argv[2]) ;
+		return 1 ;
+	}
+	fclose(f) ;
+
+	printf("%s : %ld -> %ld bytes (%ld%%)\n" , argv[1] , len , olen , len ? olen * 100 / len : 100) ;
+	return 0 ;
+}
@@ -0,0 +1,217 @@
+/*
+ * mkpack.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : build a game asset pack (see FAT16_bootloader/packfmt.h) .
+ *
+ *   mkpack [-h ids.h] out.pak [-c] name=file [[-c] name=file ...]
+ *
+ *   -h ids.h : also write a header with one ASSET_<NAME> id constant per asset
+ *   -c       : mark the following asset as compressed
+ *
+ * Build : gcc -O2 -o mkpack mkpack.c
+ *
+ * Copy the pack to the card as one file . pk_open() refuses fragmented
+ * packs , a freshly formatted card always stores it contiguously .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../FAT16_bootloader/packfmt.h"
+
+typedef struct
+{
+	const char *name ;
+	const char *path ;
+	uint32_t id ;
+	uint32_t sector ;
+	uint32_t length ;
+	uint8_t flags ;
+}ASSET_IN ;
+
+static void put16(uint8_t *p , uint16_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ;
+}
+
+static void put32(uint8_t *p , uint32_t v)
+{
+	p[0] = v ; p[1] = v >> 8 ; p[2] = v >> 16 ; p[3] = v >> 24 ;
+}
+
+static long file_length(const char *path)
+{
+	FILE *f = fopen(path , "rb") ;
+	long len ;
+
+	if(!f) return -1 ;
+	fseek(f , 0 , SEEK_END) ;
+	len = ftell(f) ;
+	fclose(f) ;
+	return len ;
+}
+
+static int copy_padded(FILE *out , const char *path)
+{
+	// Copy asset data and pad it with zeros to the next sector boundary .
+	uint8_t buf[PACK_SECTOR_SIZE] ;
+	size_t n , total = 0 ;
+	FILE *in = fopen(path , "rb") ;
+
+	if(!in) return -1 ;
+	while( (n = fread(buf , 1 , sizeof(buf) , in)) > 0 )
+	{
+		fwrite(buf , 1 , n , out) ;
+		total += n ;
+	}
+	fclose(in) ;
+
+	memset(buf , 0 , sizeof(buf)) ;
+	if(total % PACK_SECTOR_SIZE)
+	   fwrite(buf , 1 , PACK_SECTOR_SIZE - total % PACK_SECTOR_SIZE , out) ;
+
+	return 0 ;
+}
+
+static void write_ids(const char *path , const ASSET_IN *as , int count)
+{
+	FILE *h = fopen(path , "w") ;
+
+	if(!h)
+	{
+		perror(path) ;
+		exit(1) ;
+	}
+	fprintf(h , "/* Generated by mkpack , do not edit . */\n\n#ifndef ASSET_IDS_H_\n#define ASSET_IDS_H_\n\n") ;
+	for(int i = 0 ; i<count ; i++)
+	{
+		fprintf(h , "#define ASSET_") ;
+		for(const char *c = as[i].name ; *c ; c++)
+		   fputc(isalnum((unsigned char)*c) ? toupper((unsigned char)*c) : '_' , h) ;
+		fprintf(h , " 0x%08lXUL\n" , (unsigned long)as[i].id) ;
+	}
+	fprintf(h , "\n#endif /* ASSET_IDS_H_ */\n") ;
+	fclose(h) ;
+}
+
+int main(int argc , char **argv)
+{
+	const char *ids_path = NULL , *out_path = NULL ;
+	ASSET_IN *as = calloc(argc , sizeof(ASSET_IN)) ;
+	int count = 0 ;
+	uint8_t compressed = 0 ;
+
+	// 1- Parse command line .
+	for(int i = 1 ; i<argc ; i++)
+	{
+		if(!strcmp(argv[i] , "-h") && i+1 < argc)
+		   ids_path = argv[++i] ;
+		else if(!strcmp(argv[i] , "-c"))
+		   compressed = PACK_FLAG_COMPRESSED ;
+		else if(!out_path)
+		   out_path = argv[i] ;
+		else
+		{
+			char *eq = strchr(argv[i] , '=') ;
+			if(!eq)
+			{
+				fprintf(stderr , "mkpack: expected name=file , got %s\n" , argv[i]) ;
+				return 1 ;
+			}
+			*eq = '\0' ;
+			as[count].name = argv[i] ;
+			as[count].path = eq + 1 ;
+			as[count].id = pack_hash(argv[i]) ;
+			as[count].flags = compressed ;
+			compressed = 0 ;
+			count++ ;
+		}
+	}
+	if(!out_path || !count)
+	{
+		fprintf(stderr , "usage: mkpack [-h ids.h] out.pak [-c] name=file [[-c] name=file ...]\n") ;
+		return 1 ;
+	}
+
+	// 2- Size the TOC at most half full so lookups almost always hit on the first probe .
+	uint32_t slots = PACK_MIN_SLOTS ;
+	while(slots < 2UL * count) slots <<= 1 ;
+	if(slots > 0x8000)
+	{
+		fprintf(stderr , "mkpack: too many assets\n") ;
+		return 1 ;
+	}
+
+	uint32_t sector = PACK_TOC_SECTOR + slots / PACK_ENTRIES_PER_SECTOR ;
+	uint8_t *toc = calloc(slots , PACK_ENTRY_SIZE) ;
+
+	for(int i = 0 ; i<count ; i++)
+	{
+		long len = file_length(as[i].path) ;
+		if(len < 0)
+		{
+			perror(as[i].path) ;
+			return 1 ;
+		}
+		as[i].length = (uint32_t)len ;
+		as[i].sector = sector ;
+		sector += (as[i].length + PACK_SECTOR_SIZE - 1) / PACK_SECTOR_SIZE ;
+
+		// Linear probing , same order as pk_find() .
+		uint32_t slot = as[i].id & (slots - 1) ;
+		uint8_t *ent ;
+		while(1)
+		{
+			ent = toc + slot * PACK_ENTRY_SIZE ;
+			uint32_t eid = ent[0] | ent[1] << 8 | ent[2] << 16 | (uint32_t)ent[3] << 24 ;
+			if(!eid) break ;
+			if(eid == as[i].id)
+			{
+				fprintf(stderr , "mkpack: %s collides with another asset name\n" , as[i].name) ;
+				return 1 ;
+			}
+			slot = (slot + 1) & (slots - 1) ;
+		}
+		put32(ent + PACK_ENT_ID , as[i].id) ;
+		put32(ent + PACK_ENT_SECTOR , as[i].sector) ;
+		put32(ent + PACK_ENT_LENGTH , as[i].length) ;
+		ent[PACK_ENT_FLAGS] = as[i].flags ;
+	}
+
+	// 3- Write header , TOC and sector aligned asset data .
+	FILE *out = fopen(out_path , "wb") ;
+	if(!out)
+	{
+		perror(out_path) ;
+		return 1 ;
+	}
+
+	uint8_t hdr[PACK_SECTOR_SIZE] = {0} ;
+	put32(hdr + PACK_HDR_MAGIC , PACK_MAGIC) ;
+	put16(hdr + PACK_HDR_VERSION , PACK_VERSION) ;
+	put16(hdr + PACK_HDR_SLOTS , (uint16_t)slots) ;
+	put16(hdr + PACK_HDR_COUNT , (uint16_t)count) ;
+	fwrite(hdr , 1 , sizeof(hdr) , out) ;
+	fwrite(toc , PACK_ENTRY_SIZE , slots , out) ;
+
+	for(int i = 0 ; i<count ; i++)
+	{
+		if(copy_padded(out , as[i].path))
+		{
+			perror(as[i].path) ;
+			return 1 ;
+		}
+		printf("%-24s id 0x%08lX sector %6lu length %8lu%s\n" , as[i].name , (unsigned long)as[i].id ,
+		       (unsigned long)as[i].sector , (unsigned long)as[i].length , as[i].flags ? " (compressed)" : "") ;
+	}
+	fclose(out) ;
+
+	if(ids_path)
+	   write_ids(ids_path , as , count) ;
+
+	return 0 ;
+}
@@ -0,0 +1,318 @@
+/*
+ * telemdec.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : decode the telemetry stream of telem.c (see telemfmt.h)
+ * into CSV or JSON lines .
+ *
+ *   telemdec [-j | -t] [-n names] [-b baud] input
+ *
+ *   input : serial port , capture file or - for stdin
+ *   -j    : one JSON object per record instead of CSV
+ *   -t    : trace events only , as a timeline (time , delta , event , arg)
+ *   -n    : trace event names , lines of "id name" (driver events are built in)
+ *   -b    : baud rate when input is a serial port (default 38400)
+ *
+ * Build : gcc -O2 -o telemdec telemdec.c   (Linux / macOS)
+ *
+ * CSV columns are seq,type,f1,f2,f3 :
+ *   counter  id , value
+ *   frame    frame , frame_us , busy_us
+ *   sd       sectors , errors , read_us
+ *   event    id , data (hex)
+ *   trace    time in us since the first event , event , arg  (one row per event)
+ *   lost     records missing before this seq
+ *
+ * Frames with a bad CRC are skipped , counts are printed on stderr at the
+ * end of the input (Ctrl-C for a serial port) .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "../telemfmt.h"
+#include "../trace.h"
+
+static int json , timeline ;
+static char *trace_names[256] ;
+static long n_records , n_lost , n_bad ;
+static volatile sig_atomic_t stop ;
+
+static uint16_t ld16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 ;
+}
+
+static uint32_t ld32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24 ;
+}
+
+static speed_t baud_const(long baud)
+{
+	switch(baud)
+	{
+		case 9600 :    return B9600 ;
+		case 19200 :   return B19200 ;
+		case 38400 :   return B38400 ;
+		case 57600 :   return B57600 ;
+		case 115200 :  return B115200 ;
+		case 230400 :  return B230400 ;
+#ifdef B500000
+		case 500000 :  return B500000 ;   // Linux only , exact at 8 MHz with U2X .
+		case 1000000 : return B1000000 ;
+#endif
+		default :      return 0 ;
+	}
+}
+
+static int open_input(const char *path , long baud)
+{
+	struct termios tio ;
+	int fd = strcmp(path , "-") ? open(path , O_RDONLY | O_NOCTTY) : 0 ;
+
+	if(fd < 0)
+	   return -1 ;
+	if(isatty(fd) && !tcgetattr(fd , &tio))
+	{
+		if(!baud_const(baud))
+		{
+			fprintf(stderr , "telemdec: %ld baud not supported\n" , baud) ;
+			return -1 ;
+		}
+		cfmakeraw(&tio) ;
+		tio.c_cflag |= CLOCAL | CREAD ;
+		tio.c_cc[VMIN] = 1 ;
+		tio.c_cc[VTIME] = 0 ;
+		cfsetispeed(&tio , baud_const(baud)) ;
+		cfsetospeed(&tio , baud_const(baud)) ;
+		if(tcsetattr(fd , TCSANOW , &tio))
+		   return -1 ;
+		tcflush(fd , TCIFLUSH) ;
+	}
+	return fd ;
+}
+
+static void on_signal(int sig)
+{
+	(void)sig ;
+	stop = 1 ;
+}
+
+static void load_names(const char *path)
+{
+	FILE *f = fopen(path , "r") ;
+	char line[128] , name[64] ;
+	long id ;
+
+	if(!f)
+	{
+		perror(path) ;
+		exit(1) ;
+	}
+	while(fgets(line , sizeof(line) , f))
+	{
+		if(sscanf(line , "%li %63s" , &id , name) == 2 && id >= 0 && id < 256)
+		   trace_names[id] = strdup(name) ;
+	}
+	fclose(f) ;
+}
+
+static void print_trace(uint8_t seq , const uint8_t *p , int len)
+{
+	// Timer1 stamps are unwrapped across records : events less than 65536 ticks apart .
+	static int have_time ;
+	static uint16_t last_time ;
+	static uint64_t ticks ;
+	static double last_us ;
+	uint32_t tick_ns = ld32(p) ;
+
+	for(int i = 4 ; i + 5 <= len ; i += 5)
+	{
+		uint16_t t = ld16(p + i + 1) , arg = ld16(p + i + 3) ;
+		const char *name = trace_names[p[i]] ;
+		char num[8] ;
+
+		if(have_time) ticks += (uint16_t)(t - last_time) ;
+		have_time = 1 ;
+		last_time = t ;
+		double us = (double)ticks * tick_ns / 1000.0 ;
+		if(!name)
+		{
+			snprintf(num , sizeof(num) , "%u" , p[i]) ;
+			name = num ;
+		}
+
+		if(timeline) printf("%12.3f ms %+12.1f us  %-12s %u\n" , us / 1000.0 , us - last_us , name , arg) ;
+		else if(json) printf("{\"seq\":%u,\"type\":\"trace\",\"t_us\":%.1f,\"id\":%u,\"name\":\"%s\",\"arg\":%u}\n" , seq , us , p[i] , name , arg) ;
+		else printf("%u,trace,%.1f,%s,%u\n" , seq , us , name , arg) ;
+		last_us = us ;
+	}
+}
+
+static void print_record(uint8_t type , uint8_t seq , const uint8_t *p , int len)
+{
+	static const char *names[] = { "?" , "counter" , "frame" , "sd" , "event" } ;
+	const char *name = (type <= TELEM_EVENT) ? names[type] : "?" ;
+
+	if(type == TELEM_TRACE && len >= 4 && (len - 4) % 5 == 0)
+	{
+		print_trace(seq , p , len) ;
+		return ;
+	}
+	if(timeline)
+	   return ;
+
+	if(type == TELEM_COUNTER && len == 5)
+	{
+		if(json) printf("{\"seq\":%u,\"type\":\"%s\",\"id\":%u,\"value\":%lu}\n" , seq , name , p[0] , (unsigned long)ld32(p + 1)) ;
+		else     printf("%u,%s,%u,%lu,\n" , seq , name , p[0] , (unsigned long)ld32(p + 1)) ;
+	}
+	else if(type == TELEM_FRAME && len == 6)
+	{
+		if(json) printf("{\"seq\":%u,\"type\":\"%s\",\"frame\":%u,\"frame_us\":%u,\"busy_us\":%u}\n" , seq , name , ld16(p) , ld16(p + 2) , ld16(p + 4)) ;
+		else     printf("%u,%s,%u,%u,%u\n" , seq , name , ld16(p) , ld16(p + 2) , ld16(p + 4)) ;
+	}
+	else if(type == TELEM_SD && len == 8)
+	{
+		if(json) printf("{\"seq\":%u,\"type\":\"%s\",\"sectors\":%lu,\"errors\":%u,\"read_us\":%u}\n" , seq , name , (unsigned long)ld32(p) , ld16(p + 4) , ld16(p + 6)) ;
+		else     printf("%u,%s,%lu,%u,%u\n" , seq , name , (unsigned long)ld32(p) , ld16(p + 4) , ld16(p + 6)) ;
+	}
+	else if(type == TELEM_EVENT && len >= 2)
+	{
+		if(json) printf("{\"seq\":%u,\"type\":\"%s\",\"id\":%u,\"data\":\"" , seq , name , ld16(p)) ;
+		else     printf("%u,%s,%u," , seq , name , ld16(p)) ;
+		for(int i = 2 ; i<len ; i++) printf("%02x" , p[i]) ;
+		printf(json ? "\"}\n" : ",\n") ;
+	}
+	else
+	{
+		// Unknown type or wrong length : newer firmware , keep the raw payload .
+		if(json) printf("{\"seq\":%u,\"type\":%u,\"raw\":\"" , seq , type) ;
+		else     printf("%u,%u," , seq , type) ;
+		for(int i = 0 ; i<len ; i++) printf("%02x" , p[i]) ;
+		printf(json ? "\"}\n" : ",,\n") ;
+	}
+}
+
+static void frame_done(const uint8_t *enc , int len)
+{
+	// COBS decode , check the CRC , report records lost before this one .
+	static int have_seq ;
+	static uint8_t next_seq ;
+	uint8_t rec[TELEM_MAX_FRAME] ;
+	int n = 0 , i = 0 ;
+	uint16_t crc = 0xFFFF ;
+
+	while(i < len)
+	{
+		int code = enc[i++] ;
+		if(!code || i + code - 1 > len)
+		{
+			n_bad++ ;
+			return ;
+		}
+		memcpy(rec + n , enc + i , code - 1) ;
+		n += code - 1 ;
+		i += code - 1 ;
+		if(i < len)
+		   rec[n++] = 0 ;
+	}
+	if(n < 4)
+	{
+		if(len) n_bad++ ;
+		return ;
+	}
+	for(i = 0 ; i < n - 2 ; i++) crc = telem_crc16(crc , rec[i]) ;
+	if(crc != ld16(rec + n - 2))
+	{
+		n_bad++ ;
+		return ;
+	}
+
+	if(have_seq && rec[1] != next_seq && !timeline)
+	{
+		uint8_t lost = rec[1] - next_seq ;
+		n_lost += lost ;
+		if(json) printf("{\"seq\":%u,\"type\":\"lost\",\"count\":%u}\n" , rec[1] , lost) ;
+		else     printf("%u,lost,%u,,\n" , rec[1] , lost) ;
+	}
+	have_seq = 1 ;
+	next_seq = rec[1] + 1 ;
+	n_records++ ;
+	print_record(rec[0] , rec[1] , rec + 2 , n - 4) ;
+}
+
+int main(int argc , char **argv)
+{
+	long baud = 38400 ;
+	const char *path = NULL ;
+
+	trace_names[TRACE_SD_READ] = "sd_read" ;
+	trace_names[TRACE_SD_DONE] = "sd_done" ;
+	trace_names[TRACE_FLASH_ERASE] = "flash_erase" ;
+	trace_names[TRACE_FLASH_DONE] = "flash_done" ;
+	trace_names[TRACE_UART_RX] = "uart_rx" ;
+
+	for(int i = 1 ; i<argc ; i++)
+	{
+		if(!strcmp(argv[i] , "-j"))
+		   json = 1 ;
+		else if(!strcmp(argv[i] , "-t"))
+		   timeline = 1 ;
+		else if(!strcmp(argv[i] , "-n") && i+1 < argc)
+		   load_names(argv[++i]) ;
+		else if(!strcmp(argv[i] , "-b") && i+1 < argc)
+		   baud = strtol(argv[++i] , NULL , 0) ;
+		else
+		   path = argv[i] ;
+	}
+	if(!path)
+	{
+		fprintf(stderr , "usage: telemdec [-j | -t] [-n names] [-b baud] input\n") ;
+		return 1 ;
+	}
+
+	int fd = open_input(path , baud) ;
+	if(fd < 0)
+	{
+		perror(path) ;
+		return 1 ;
+	}
+	signal(SIGINT , on_signal) ;
+	signal(SIGTERM , on_signal) ;
+	setvbuf(stdout , NULL , _IOLBF , 0) ;
+	if(!json && !timeline)
+	   printf("seq,type,f1,f2,f3\n") ;
+
+	// Frames longer than any record are junk (no delimiter seen) , dropped when they end .
+	uint8_t buf[4096] , frame[TELEM_MAX_FRAME] ;
+	int fill = 0 , overlong = 0 ;
+	ssize_t got ;
+
+	while(!stop && (got = read(fd , buf , sizeof(buf))) > 0)
+	{
+		for(ssize_t i = 0 ; i<got ; i++)
+		{
+			if(!buf[i])
+			{
+				if(overlong) n_bad++ ;
+				else frame_done(frame , fill) ;
+				fill = overlong = 0 ;
+			}
+			else if(fill < (int)sizeof(frame))
+			   frame[fill++] = buf[i] ;
+			else
+			   overlong = 1 ;
+		}
+	}
+
+	fprintf(stderr , "telemdec: %ld records , %ld lost , %ld bad frames\n" , n_records , n_lost , n_bad) ;
+	return 0 ;
+}
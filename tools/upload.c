@@ -0,0 +1,298 @@
+/*
+ * upload.c
+ *
+ * Created: 10/19/2026
+ *
+ * Host tool : send an image made by mkimage to SD_Bootloader.c over a
+ * serial port (see uploadfmt.h) .
+ *
+ *   upload [-b baud] port app.img
+ *
+ *   -b : baud rate (default UPLOAD_BAUD , 500000 needs Linux . Elsewhere
+ *        build the bootloader with -DUPLOAD_BAUD=38400 and pass -b 38400)
+ *
+ * Build : gcc -O2 -o upload upload.c   (Linux / macOS)
+ *
+ * Start it , then reset the board : HELLO is repeated back to back until
+ * the bootloader answers , it only listens when it sees the line busy right
+ * after reset . Debug text the bootloader prints on the same port is skipped .
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/select.h>
+
+#include "../imgfmt.h"
+#include "../uploadfmt.h"
+
+#define HELLO_PERIOD_MS   1       // HELLO repeat , keeps the gaps below UPLOAD_SENSE_MS
+#define HELLO_TIMEOUT_MS  30000
+#define REPLY_TIMEOUT_MS  1000
+#define VERIFY_TIMEOUT_MS 10000   // END reply comes after the whole flash is read back
+#define MAX_RETRIES       10
+
+static int port ;
+
+static uint16_t ld16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 ;
+}
+
+static uint32_t ld32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24 ;
+}
+
+static long now_ms(void)
+{
+	struct timespec ts ;
+
+	clock_gettime(CLOCK_MONOTONIC , &ts) ;
+	return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L ;
+}
+
+static speed_t baud_const(long baud)
+{
+	switch(baud)
+	{
+		case 9600 :   return B9600 ;
+		case 19200 :  return B19200 ;
+		case 38400 :  return B38400 ;
+		case 57600 :  return B57600 ;
+		case 115200 : return B115200 ;
+		case 230400 : return B230400 ;
+#ifdef B500000
+		case 500000 : return B500000 ;   // Linux only , exact at 8 MHz with U2X .
+#endif
+		default :     return 0 ;
+	}
+}
+
+static int open_port(const char *path , long baud)
+{
+	struct termios tio ;
+	int fd = open(path , O_RDWR | O_NOCTTY) ;
+
+	if(fd < 0 || tcgetattr(fd , &tio))
+	   return -1 ;
+	cfmakeraw(&tio) ;
+	tio.c_cflag |= CLOCAL | CREAD ;
+	tio.c_cc[VMIN] = 0 ;
+	tio.c_cc[VTIME] = 0 ;
+	cfsetispeed(&tio , baud_const(baud)) ;
+	cfsetospeed(&tio , baud_const(baud)) ;
+	if(tcsetattr(fd , TCSANOW , &tio))
+	   return -1 ;
+	tcflush(fd , TCIOFLUSH) ;
+	return fd ;
+}
+
+static void send_frame(uint8_t type , uint8_t seq , const uint8_t *data , uint16_t len)
+{
+	uint8_t frame[5 + 0xFFFF + 2] ;
+	uint16_t crc = 0xFFFF ;
+	size_t n = 0 ;
+
+	frame[n++] = UPLOAD_SOF ;
+	frame[n++] = type ;
+	frame[n++] = seq ;
+	frame[n++] = len ;
+	frame[n++] = len >> 8 ;
+	memcpy(frame + n , data , len) ;
+	n += len ;
+	for(size_t i = 1 ; i<n ; i++) crc = upload_crc16(crc , frame[i]) ;
+	frame[n++] = crc ;
+	frame[n++] = crc >> 8 ;
+
+	if(write(port , frame , n) != (ssize_t)n)
+	{
+		perror("write") ;
+		exit(1) ;
+	}
+}
+
+// Next valid reply within timeout_ms , 0 on timeout . Bytes around replies are skipped .
+static int get_reply(uint8_t reply[3] , long timeout_ms)
+{
+	static uint8_t buf[6] ;
+	static int fill ;
+	long end = now_ms() + timeout_ms ;
+
+	while(1)
+	{
+		long left = end - now_ms() ;
+		if(left <= 0)
+		   return 0 ;
+
+		fd_set fds ;
+		struct timeval tv = { left / 1000 , (left % 1000) * 1000 } ;
+		FD_ZERO(&fds) ;
+		FD_SET(port , &fds) ;
+		if(select(port + 1 , &fds , NULL , NULL , &tv) <= 0)
+		   continue ;
+
+		uint8_t ch ;
+		if(read(port , &ch , 1) != 1)
+		   continue ;
+		if(!fill && ch != UPLOAD_SOF)
+		   continue ;
+		buf[fill++] = ch ;
+		if(fill < 6)
+		   continue ;
+
+		fill = 0 ;
+		uint16_t crc = upload_crc16(upload_crc16(upload_crc16(0xFFFF , buf[1]) , buf[2]) , buf[3]) ;
+		if(crc != ld16(buf + 4) || (buf[1] != UPLOAD_ACK && buf[1] != UPLOAD_NAK))
+		   continue ;
+		memcpy(reply , buf + 1 , 3) ;
+		return 1 ;
+	}
+}
+
+static uint8_t *load(const char *path , long *len)
+{
+	FILE *f = fopen(path , "rb") ;
+	uint8_t *data ;
+
+	if(!f) return NULL ;
+	fseek(f , 0 , SEEK_END) ;
+	*len = ftell(f) ;
+	rewind(f) ;
+	data = malloc(*len + 1) ;
+	if(fread(data , 1 , *len , f) != (size_t)*len)
+	{
+		fclose(f) ;
+		free(data) ;
+		return NULL ;
+	}
+	fclose(f) ;
+	return data ;
+}
+
+int main(int argc , char **argv)
+{
+	long baud = UPLOAD_BAUD ;
+	const char *path[2] ;
+	int n_path = 0 ;
+
+	for(int i = 1 ; i<argc ; i++)
+	{
+		if(!strcmp(argv[i] , "-b") && i+1 < argc)
+		   baud = strtol(argv[++i] , NULL , 0) ;
+		else if(n_path < 2)
+		   path[n_path++] = argv[i] ;
+	}
+	if(n_path != 2 || !baud_const(baud))
+	{
+		fprintf(stderr , "usage: upload [-b baud] port app.img\n") ;
+		return 1 ;
+	}
+
+	// 1- Image made by mkimage : header sector then the binary padded to whole pages .
+	long img_len ;
+	uint8_t *img = load(path[1] , &img_len) ;
+	if(!img)
+	{
+		perror(path[1]) ;
+		return 1 ;
+	}
+	if(img_len < IMG_SECTOR_SIZE || ld32(img + IMG_HDR_MAGIC) != IMG_MAGIC)
+	{
+		fprintf(stderr , "upload: %s is not a mkimage image\n" , path[1]) ;
+		return 1 ;
+	}
+	if(ld16(img + IMG_HDR_FLAGS) & IMG_FLAG_IHEX)
+	{
+		fprintf(stderr , "upload: Intel HEX images can't be uploaded , build the image from a .bin\n") ;
+		return 1 ;
+	}
+	uint16_t pages = ld16(img + IMG_HDR_PAGES) , page_size = ld16(img + IMG_HDR_PAGE_SIZE) ;
+	uint8_t *bin = calloc(pages , page_size) ;
+	memset(bin , 0xFF , (size_t)pages * page_size) ;
+	if(img_len > IMG_SECTOR_SIZE)
+	   memcpy(bin , img + IMG_SECTOR_SIZE , img_len - IMG_SECTOR_SIZE < (long)pages * page_size ? img_len - IMG_SECTOR_SIZE : (long)pages * page_size) ;
+
+	port = open_port(path[0] , baud) ;
+	if(port < 0)
+	{
+		perror(path[0]) ;
+		return 1 ;
+	}
+
+	// 2- HELLO until the bootloader answers .
+	uint8_t reply[3] ;
+	long start = now_ms() ;
+	printf("Waiting for the board , reset it ...\n") ;
+	while(1)
+	{
+		send_frame(UPLOAD_HELLO , 0 , img , IMG_HDR_SIZE) ;
+		if(get_reply(reply , HELLO_PERIOD_MS) && reply[0] == UPLOAD_ACK)
+		   break ;
+		if(now_ms() - start > HELLO_TIMEOUT_MS)
+		{
+			fprintf(stderr , "upload: no answer from the board\n") ;
+			return 1 ;
+		}
+	}
+	uint8_t extra[3] ;
+	while(get_reply(extra , 50)) ;   // Answers to repeated HELLOs
+	if(reply[2] == UPLOAD_ST_SAME)
+	{
+		printf("Application is up to date\n") ;
+		return 0 ;
+	}
+	if(reply[2] != UPLOAD_ST_OK)
+	{
+		fprintf(stderr , "upload: image refused (wrong device or page size ?)\n") ;
+		return 1 ;
+	}
+
+	// 3- Pages , up to UPLOAD_WINDOW unanswered , go back to the first unanswered one on NAK / timeout .
+	start = now_ms() ;
+	unsigned base = 0 , next = 0 , retries = 0 ;
+	while(base < pages)
+	{
+		while(next < pages && next - base < UPLOAD_WINDOW)
+		{
+			send_frame(UPLOAD_DATA , (uint8_t)next , bin + (size_t)next * page_size , page_size) ;
+			next++ ;
+		}
+		if(!get_reply(reply , REPLY_TIMEOUT_MS) || reply[0] == UPLOAD_NAK)
+		{
+			if(++retries > MAX_RETRIES)
+			{
+				fprintf(stderr , "upload: too many errors at page %u\n" , base) ;
+				return 1 ;
+			}
+			// Let frames already on the way drain , then resend from base .
+			while(get_reply(reply , 50)) ;
+			next = base ;
+			continue ;
+		}
+		uint8_t ahead = reply[1] - (uint8_t)base ;
+		if(ahead < next - base)
+		{
+			base += ahead + 1 ;
+			retries = 0 ;
+			printf("\r%u / %u pages" , base , pages) ;
+			fflush(stdout) ;
+		}
+	}
+
+	// 4- END , answered after the bootloader has verified the flash .
+	int answered ;
+	send_frame(UPLOAD_END , (uint8_t)pages , NULL , 0) ;
+	while( (answered = get_reply(reply , VERIFY_TIMEOUT_MS)) && (reply[0] != UPLOAD_ACK || reply[1] != (uint8_t)pages) ) ;
+	if(!answered || reply[2] != UPLOAD_ST_OK)
+	{
+		fprintf(stderr , "\nupload: %s\n" , answered ? "flash verify failed" : "no answer to END") ;
+		return 1 ;
+	}
+	printf("\n%u pages in %.1f s\n" , pages , (now_ms() - start) / 1000.0) ;
+	return 0 ;
+}
@@ -0,0 +1,100 @@
+/*
+ * trace.h
+ *
+ * Created: 10/19/2026
+ *
+ * Event trace for hot paths and ISRs . TRACE(id , arg) stores the event id ,
+ * a 16-bit Timer1 stamp and a 16-bit argument in a RAM ring (interrupts are
+ * held off for the few cycles of the store) , the oldest entries are
+ * overwritten . trace_dump() sends the ring later as telemetry records
+ * (see telem.h) , tools/telemdec turns them into a timeline .
+ *
+ * Build with -DTRACE_ENABLE , otherwise every TRACE() compiles to nothing .
+ *
+ * trace_start() runs Timer1 free at F_CPU / TRACE_PRESCALER (1 us ticks at
+ * 8 MHz) , the host unwraps the stamps so events must be less than 65536
+ * ticks apart . prof.c uses Timer1 too : in a bootloader build with
+ * -DTRACE_PRESCALER=1024 and let prof_start() run the timer .
+ *
+ * The event ids are also read by tools/telemdec , keep this part host safe .
+ */
+
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#ifndef TRACE_SIZE
+   #define TRACE_SIZE        32   // Entries (5 bytes each) , a power of 2 .
+#endif
+#ifndef TRACE_PRESCALER
+   #define TRACE_PRESCALER   8
+#endif
+
+// Event ids , 0x00 - 0x1F are used by the drivers , applications take the others .
+#define TRACE_SD_READ        0x01   // arg : sector (low 16 bits)
+#define TRACE_SD_DONE        0x02   // arg : 0 , 0xFFFF on error
+#define TRACE_FLASH_ERASE    0x03   // arg : flash page number
+#define TRACE_FLASH_DONE     0x04   // arg : flash page number
+#define TRACE_UART_RX        0x05   // arg : received byte
+#define TRACE_USER           0x20
+
+#if (TRACE_SIZE & (TRACE_SIZE - 1)) || (TRACE_SIZE > 256)
+   #error "TRACE_SIZE must be a power of 2 , at most 256"
+#endif
+
+#ifdef TRACE_ENABLE
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*========== Types ==========================*/
+
+typedef struct
+{
+	uint8_t id ;
+	uint16_t time ;
+	uint16_t arg ;
+}TRACE_ENTRY ;
+
+/*========== External Variables ==========================*/
+
+extern TRACE_ENTRY trace_buf[TRACE_SIZE] ;
+extern uint16_t trace_count ;   // Events recorded since trace_clear() , wraps .
+
+/*========== Functions ==========================*/
+
+static inline void trace_put( uint8_t id , uint16_t arg )
+{
+	uint8_t sreg = SREG ;
+	TRACE_ENTRY *e ;
+
+	cli() ;
+	e = &trace_buf[(uint8_t)trace_count & (TRACE_SIZE - 1)] ;
+	e->id = id ;
+	e->time = TCNT1 ;
+	e->arg = arg ;
+	trace_count++ ;
+	SREG = sreg ;
+}
+
+#define TRACE(ID , ARG)   trace_put((ID) , (ARG))
+
+void trace_start(void) ;
+void trace_clear(void) ;
+void trace_dump(void) ;
+
+#else
+
+#define TRACE(ID , ARG)
+#define trace_start()
+#define trace_clear()
+#define trace_dump()
+
+#endif /* TRACE_ENABLE */
+
+
+#endif /* TRACE_H_ */
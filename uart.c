@@ -15,91 +15,105 @@
        #define F_CPU 8000000UL
 #endif
 
-#include <stdio.h>  // sprintf usage .
+#include <stdarg.h>
  
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <avr/interrupt.h>
 #include <util/atomic.h>
+#include <util/delay.h>
 
 #include "uart.h"
+#include "trace.h"
 
 /* ==================== Data structures ================================= */
 
-//Queue data structure 
+//Queue data structure : single producer / single consumer ring .
+// head is only moved by the consumer , tail only by the producer , both run freely and
+// are masked on access , so neither side has to disable interrupts .
 
   typedef char QueueEntry ; // Queue element abstract data type entered by users .
 
   typedef struct
   {
-       uint8_t head ;
-       int8_t tail ;  // signed as it will take -1 at initialization .
-       uint8_t size_ ;
-       QueueEntry entry[MAXQUEUE] ;
+       volatile uint8_t head ;  // Next entry to serve .
+       volatile uint8_t tail ;  // Next free entry .
+       uint8_t mask ;  // Ring size - 1 .
+       volatile QueueEntry *entry ;
   }Queue_t ;
 
 // Queue data structure accessing mechanism ( function prototypes )
 
-static uint8_t InitializeQueue(volatile Queue_t *) ;
-static inline uint8_t Append(QueueEntry , volatile Queue_t *) ;
-static inline uint8_t Serve(QueueEntry *, volatile Queue_t *) ;
-static inline uint8_t QueueEmpty(volatile Queue_t *) ;
-static inline uint8_t QueueFull( volatile Queue_t *) ;
-static inline uint8_t all_served( volatile Queue_t *pq);
-static inline uint8_t ClearQueue(volatile Queue_t *) ;
+static uint8_t InitializeQueue(Queue_t *) ;
+static inline uint8_t Append(QueueEntry , Queue_t *) ;
+static inline uint8_t Serve(QueueEntry *, Queue_t *) ;
+static inline uint8_t QueueEmpty(Queue_t *) ;
+static inline uint8_t QueueFull( Queue_t *) ;
+static inline uint8_t ClearQueue(Queue_t *) ;
 
 /* =================== Global variables ================================ */
 
- volatile Queue_t recv_buffer   ;  // receive buffer
- volatile Queue_t trans_buffer  ; // transmit buffer 
+ static volatile QueueEntry recv_entry[UART_RX_SIZE] ;
+ static volatile QueueEntry trans_entry[UART_TX_SIZE] ;
+ Queue_t recv_buffer  = { 0 , 0 , UART_RX_SIZE - 1 , recv_entry }  ;  // receive buffer
+ Queue_t trans_buffer = { 0 , 0 , UART_TX_SIZE - 1 , trans_entry } ; // transmit buffer 
+ static volatile uint16_t rx_overflows ;  // Bytes dropped by the receive ISR , recv_buffer full .
+ static uint16_t tx_overflows ;  // Bytes put_TransBuffer_data() could not queue .
+ static uint16_t tx_timeout = UART_TX_TIMEOUT ;
+ static const uint8_t *tx_block ;  // Caller's buffer being sent by the UDRE ISR .
+ static uint16_t tx_block_left ;
+ static uint8_t tx_block_start ;  // trans_buffer.tail when the block was given .
+ static volatile uint8_t tx_block_busy ;
+ static UART_TX_DONE tx_block_done ;
  volatile uint16_t b_r ;
+ static UART_RX_HOOK rx_hook ;  // Takes received bytes instead of recv_buffer when set .
 /* =================== Function Definitions ================================ */
 
-uint8_t Uart_init(uint16_t b_rate) 
+uint8_t Uart_init(uint32_t b_rate) 
 {
-	// Step1 : Set baud rate reg value .
-	                           
-	volatile uint16_t baud_rate_reg ;
+	// Step1 : Set baud rate reg value , the closest of clk/16 and clk/8 (U2X) , normal speed
+	//         unless double speed is closer . Rates more than UART_MAX_ERROR off are refused .
 	
-	if(F_CPU == 8000000UL)
-	{
-		switch(b_rate)
-		{
-			case 9600 :
-			           {
-						  baud_rate_reg = 51 ;  
-					   }break;
-			
-			case 19200 :
-			            {
-							baud_rate_reg = 25 ;
-						}break ;
-			
-			case 38400 :
-			            {
-							baud_rate_reg = 12 ;
-						}break ;
-			default:
-			{
-				baud_rate_reg = F_CPU/(16UL*b_rate) -1UL ;
-			}								   
-		}// End switch
-	}// End if
+	uint16_t baud_rate_reg = 0 ;
+	uint8_t u2x = 0 ;
+	uint16_t best_err = 0xFFFF ;
 	
-	else
+	// 0 or faster than clk/8 has no setting (and 0 would divide by zero below) .
+	if(!b_rate || b_rate > F_CPU / 8UL)
+	   return 0 ;
+	
+	for( uint8_t x = 0 ; x<2 ; x++ )
 	{
-	    baud_rate_reg = (F_CPU)/(16UL*b_rate)-1UL ;
+		uint32_t div = (x ? 8UL : 16UL) * b_rate ;
+		uint32_t n = (F_CPU + div / 2) / div ;  // UBRR + 1 , rounded .
+		uint32_t real , diff ;
+		uint16_t err ;
+		
+		if(!n || n > 4096)
+		   continue ;
+		real = n * div ;
+		diff = (real > F_CPU) ? real - F_CPU : F_CPU - real ;
+		err = (diff + F_CPU / 1000UL - 1) / (F_CPU / 1000UL) ;  // per mille rounded up , as UART_BAUD_ERROR()
+		if(err < best_err)
+		{
+			best_err = err ;
+			baud_rate_reg = n - 1 ;
+			u2x = x ;
+		}
 	}
+	if(best_err > UART_MAX_ERROR)
+	   return 0 ;
 	
-		
-	   UBRRH = baud_rate_reg >> 8;
-	   UBRRL = baud_rate_reg     ;
+	UBRRH = baud_rate_reg >> 8;
+	UBRRL = baud_rate_reg     ;
+	UCSRA = u2x ? (1<<U2X) : 0 ;
 	
 	   // Step 2 : Enable Transmit , Receive And Receive Interrupt . 
 	
 	   UCSRB |= ( 1<< RXEN ) | ( 1<< TXEN ) | ( 1<< RXCIE ) ;
 	
 	   // Step 3 : Set Frame specifications to N81 [ No parity , 8bit character size and  1 stop bit ] & Asynchronous mode .
-	   #ifdef __AVR_ATmega644P__
+	   #if defined(__AVR_ATmega644P__) || defined(__AVR_ATmega1284P__)
 	      UCSRC =  ( 0 << UMSEL00 ) | ( 0 << UMSEL01 ) | ( 0 << UPM00 ) | ( 0 << UPM01 ) | ( 0 << USBS0 ) | ( 1 << UCSZ00 ) | ( 1 << UCSZ01  ) ;
 		  
 	   #else   //  __AVR_ATmega32__  
@@ -132,58 +146,132 @@ uint8_t Uart_Disable(void)
 
 char get_RecvBuffer_data(void)
 {
-	/*Note we disable interrupts and re-enable it again to save shared data to not to be interrupted during operation on it at task  (atomic block) */ 
-	QueueEntry data ;
+	// The receive ISR only moves tail and this side only moves head : no atomic block needed .
+	QueueEntry data = 0 ;
 
-	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	if( !QueueEmpty(&recv_buffer) )
 	{
-		
-	 if( !QueueEmpty(&recv_buffer) )
-	 {
-	    Serve(&data , &recv_buffer);
-	}	 	
-		return ((uint8_t)data) ;
-	  }
+	   Serve(&data , &recv_buffer);
+	}
+	
+	return data ;
+}
 
-	  return 0 ;
+static uint8_t tx_wait_room(void)
+{
+	// Full buffer : wait up to tx_timeout ms for the ISR to make room (needs interrupts enabled) .
+	// Returns the free bytes , 0 on timeout .
+	uint16_t ms = tx_timeout ;
+	uint8_t steps = 100 ;
+	
+	while( QueueFull(&trans_buffer) && ms )
+	{
+		_delay_us(10) ;
+		if(!--steps)
+		{
+			steps = 100 ;
+			ms-- ;
+		}
+	}
+	
+	return Uart_Tx_Free() ;
 }
 
 uint8_t put_TransBuffer_data(char data) 
 {
-	//Keep in mind that if the data to be transmit has length > MAX_TRANS_CH it will cause overflow in circular buffer and some data will lost 
-	// take care of that !!! .
+	// Byte dropped and counted when the buffer stays full for tx_timeout ms .
 	
-	if( !QueueFull(&trans_buffer) )  // this check prevent put in the buffer more than MAX_TRANS_CH and without serve loaded data in the buffer .
+	if( tx_wait_room() )  // this check prevent put in the buffer more than MAX_TRANS_CH and without serve loaded data in the buffer .
 	{
 		Append((QueueEntry)data , &trans_buffer) ;
-		SETBIT(UCSRB , UDRIE) ;  // Enable UDRE interrupt .
+		SETBIT(UCSRB , UDRIE) ;  // Enable UDRE interrupt , after Append so the ISR finds the data .
 		return 1 ;
 		
 	}
 	
 	
+	tx_overflows++ ;
 	return 0 ;  //failed to insert new data to the transmit buffer .
 	
 }
 
+uint16_t put_TransBuffer_Block(const uint8_t *buf , uint16_t len)
+{
+	// Copy as much as fits in one go and publish it with a single tail update , then wait for
+	// room (tx_timeout) for the rest . Returns the bytes queued , the others are counted as lost .
+	uint16_t done = 0 ;
+	uint8_t room ;
+	
+	while( done < len && (room = tx_wait_room()) )
+	{
+		uint8_t tail = trans_buffer.tail ;
+		
+		if(room > len - done)
+		   room = len - done ;
+		done += room ;
+		while(room--)
+		   trans_buffer.entry[tail++ & trans_buffer.mask] = *buf++ ;
+		trans_buffer.tail = tail ;
+		SETBIT(UCSRB , UDRIE) ;
+	}
+	
+	tx_overflows += len - done ;
+	return done ;
+}
+
 uint8_t put_TransBuffer_String(char *str)
 {
+	// Line by line as blocks , line feeds go out as LF CR .
 	while(*str)
 	{
+		char *end = str ;
+		while(*end && *end != 0x0A)
+		   end++ ;
+		put_TransBuffer_Block((const uint8_t *)str , end - str) ;
+		str = end ;
 		if(*str == 0x0A)  //  line feed
 		{
-			put_TransBuffer_data(0x0A) ;
-			put_TransBuffer_data(0x0D) ;
+			put_TransBuffer_Block((const uint8_t *)"\n\r" , 2) ;
 			str++ ;
 		}
-		else
-		   put_TransBuffer_data(*str++) ;
 	}
 	put_TransBuffer_data('\0') ;
 	
 	return 1 ;
 }
 
+uint8_t Uart_Transmit_Buffer(const uint8_t *buf , uint16_t len , UART_TX_DONE done)
+{
+	// Zero copy : the UDRE ISR sends buf itself , after the bytes already queued and before the
+	// ones queued later . buf must stay untouched until done() is called from the ISR (or
+	// Uart_Tx_Block_Busy() returns 0) . 0 if a buffer is still being sent .
+	if(tx_block_busy)
+	   return 0 ;
+	if(!len)
+	{
+		if(done)
+		   done() ;
+		return 1 ;
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		tx_block = buf ;
+		tx_block_left = len ;
+		tx_block_done = done ;
+		tx_block_start = trans_buffer.tail ;
+		tx_block_busy = 1 ;
+		SETBIT(UCSRB , UDRIE) ;
+	}
+	
+	return 1 ;
+}
+
+uint8_t Uart_Tx_Block_Busy(void)
+{
+	return tx_block_busy ;
+}
+
 uint8_t Uart_Transimit_chr(char ch) 
 {
 	while ( !( UCSRA & (1<<UDRE)) ) ;
@@ -250,17 +338,220 @@ uint8_t Uart_Receive_String(char *str)
 	return 1 ;
 }
 
+void Uart_Set_Rx_Hook(UART_RX_HOOK hook)
+{
+	// hook is called from the receive ISR with every byte , keep it short .
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		rx_hook = hook ;
+	}
+}
+
+void Uart_Set_Tx_Timeout(uint16_t ms)
+{
+	// 0 : put_TransBuffer_data() never waits , drops the byte when the buffer is full .
+	tx_timeout = ms ;
+}
+
+uint16_t Uart_Rx_Overflows(void)
+{
+	uint16_t n ;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		n = rx_overflows ;
+	}
+	return n ;
+}
+
+uint16_t Uart_Tx_Overflows(void)
+{
+	return tx_overflows ;
+}
+
+uint8_t Uart_Tx_Free(void)
+{
+	// Bytes put_TransBuffer_data() takes without waiting , only grows until the next put .
+	return (trans_buffer.mask + 1) - (uint8_t)(trans_buffer.tail - trans_buffer.head) ;
+}
+
 void Uart_Newline(void)
 {
 	Uart_Transimit_chr(0x0D) ;
 	Uart_Transimit_chr(0x0A) ;
 }
 
+/* =================== Formatter ================================ */
+
+// Output functions of the formatter : polled , or into the transmit buffer (never waits
+// longer than the tx timeout) . Line feeds go out as LF CR like Uart_Transimit_String() .
+
+typedef void (*FMT_PUT)(char ch) ;
+
+static void poll_put(char ch)
+{
+	Uart_Transimit_chr(ch) ;
+	if(ch == 0x0A)
+	   Uart_Transimit_chr(0x0D) ;
+}
+
+static void ring_put(char ch)
+{
+	put_TransBuffer_data(ch) ;
+	if(ch == 0x0A)
+	   put_TransBuffer_data(0x0D) ;
+}
+
+static void fmt_number(FMT_PUT put , uint32_t n , uint8_t base , uint8_t width , char pad , char sign)
+{
+	// sign is '-' or 0 , it goes before zero padding and after space padding .
+	char digits[10] ;  // 4294967295 .
+	uint8_t len = 0 ;
+	
+	do
+	{
+		uint8_t d = (base == 16) ? (n & 0x0F) : (n % 10) ;
+		digits[len++] = (d < 10) ? ('0' + d) : ('A' - 10 + d) ;
+		n = (base == 16) ? (n >> 4) : (n / 10) ;
+	}while(n) ;
+	
+	if(sign)
+	{
+		if(width)
+		   width-- ;
+		if(pad == '0')
+		   put(sign) ;
+	}
+	while(width > len)
+	{
+		put(pad) ;
+		width-- ;
+	}
+	if(sign && pad != '0')
+	   put(sign) ;
+	while(len)
+	   put(digits[--len]) ;
+}
+
+static void fmt_signed(FMT_PUT put , int32_t n , uint8_t width , char pad)
+{
+	if(n < 0)
+	   fmt_number(put , -(uint32_t)n , 10 , width , pad , '-') ;
+	else
+	   fmt_number(put , n , 10 , width , pad , 0) ;
+}
+
+static void fmt_fixed(FMT_PUT put , int32_t f)
+{
+	// 16.16 fixed point , 4 decimals rounded .
+	uint32_t n = f ;
+	uint16_t frac ;
+	
+	if(f < 0)
+	{
+		put('-') ;
+		n = -(uint32_t)f ;
+	}
+	frac = ( (n & 0xFFFF) * 10000UL + 0x8000 ) >> 16 ;
+	n >>= 16 ;
+	if(frac == 10000)
+	{
+		frac = 0 ;
+		n++ ;
+	}
+	fmt_number(put , n , 10 , 0 , ' ' , 0) ;
+	put('.') ;
+	fmt_number(put , frac , 10 , 4 , '0' , 0) ;
+}
+
 void Uart_Print_Int(int num) 
 {
-	char int_str[6] ;
-	sprintf(int_str , "%d" , num) ;
-	Uart_Transimit_String(int_str) ;
+	// Polled like Uart_Transimit_String() , works with interrupts disabled .
+	fmt_signed(poll_put , num , 0 , ' ') ;
+}
+
+void Uart_Printf_P(const char *fmt , ...)
+{
+	// Formats straight into the transmit buffer , see uart.h for the conversions .
+	va_list ap ;
+	char ch ;
+	
+	va_start(ap , fmt) ;
+	while( (ch = pgm_read_byte(fmt++)) )
+	{
+		uint8_t width = 0 , is_long = 0 ;
+		char pad = ' ' ;
+		
+		if(ch != '%')
+		{
+			ring_put(ch) ;
+			continue ;
+		}
+		
+		ch = pgm_read_byte(fmt++) ;
+		if(ch == '0')
+		{
+			pad = '0' ;
+			ch = pgm_read_byte(fmt++) ;
+		}
+		if(ch >= '1' && ch <= '9')
+		{
+			width = ch - '0' ;
+			ch = pgm_read_byte(fmt++) ;
+		}
+		if(ch == 'l')
+		{
+			is_long = 1 ;
+			ch = pgm_read_byte(fmt++) ;
+		}
+		
+		switch(ch)
+		{
+			case 'd' :
+				fmt_signed(ring_put , is_long ? va_arg(ap , int32_t) : va_arg(ap , int) , width , pad) ;
+				break ;
+			
+			case 'u' :
+				fmt_number(ring_put , is_long ? va_arg(ap , uint32_t) : va_arg(ap , unsigned int) , 10 , width , pad , 0) ;
+				break ;
+			
+			case 'x' :
+			case 'X' :
+				fmt_number(ring_put , is_long ? va_arg(ap , uint32_t) : va_arg(ap , unsigned int) , 16 , width , pad , 0) ;
+				break ;
+			
+			case 'q' :
+				fmt_fixed(ring_put , va_arg(ap , int32_t)) ;
+				break ;
+			
+			case 'c' :
+				ring_put((char)va_arg(ap , int)) ;
+				break ;
+			
+			case 's' :
+			{
+				const char *s = va_arg(ap , const char *) ;
+				while(*s)
+				   ring_put(*s++) ;
+			}break ;
+			
+			case 'S' :
+			{
+				const char *s = va_arg(ap , const char *) ;
+				while( (ch = pgm_read_byte(s++)) )
+				   ring_put(ch) ;
+			}break ;
+			
+			case '\0' :
+				fmt-- ;  // Lone % at the end .
+				break ;
+			
+			default :
+				ring_put(ch) ;  // %% and unknown conversions print the character .
+				break ;
+		}
+	}
+	va_end(ap) ;
 }
 
 /* =================== Interrupt Service Routines ================================ */
@@ -270,18 +561,25 @@ void Uart_Print_Int(int num)
 ISR(USART_RXC_vect)
 {
 	//If there is any new received data??
+	uint8_t data = UDR ;
+	
+	TRACE(TRACE_UART_RX , data) ;
+	if(rx_hook)
+	{
+		rx_hook(data) ;
+		return ;
+	}
 	 
-	//Keep in mind that if the received data length > MAX_RECV_CH it will cause overflow in circular buffer and some data will lost 
-	// take care of that !!! .
+	// Bytes received while the buffer is full are dropped and counted (Uart_Rx_Overflows) .
 	
   	if( !QueueFull(&recv_buffer) )  // this check prevent put in the buffer more than MAX_RECV_CH and without serve loaded data in the buffer .
 	  {
-		  Append( UDR , &recv_buffer) ;
+		  Append( data , &recv_buffer) ;
 	  }
 	  
 	  else
 	  {
-		  uint8_t flush_temp = UDR ;  // Read receive buffer to flush it and make RCX bit zero .
+		  rx_overflows++ ;  // UDR already read , RXC is cleared .
 	  }
 	  
 }
@@ -290,8 +588,20 @@ ISR(USART_RXC_vect)
 ISR(USART_UDRE_vect)
 {
    // Now Transmit buffer ready to go out >>>> UDR .
+   // A block from Uart_Transmit_Buffer() goes out once the bytes queued before it are sent .
    
-   if( !QueueEmpty(&trans_buffer) )
+   if( tx_block_busy && trans_buffer.head == tx_block_start )
+   {
+	   UDR = *tx_block++ ;
+	   if(!--tx_block_left)
+	   {
+		   tx_block_busy = 0 ;
+		   if(tx_block_done)
+		      tx_block_done() ;
+	   }
+   }
+   
+   else if( !QueueEmpty(&trans_buffer) )
    {
 	    Serve( (QueueEntry *)&UDR , &trans_buffer) ;
    }
@@ -304,56 +614,52 @@ ISR(USART_UDRE_vect)
 }
 /* =================== Queue data structure accessing mechanism  ================================ */
 
-static uint8_t InitializeQueue(volatile Queue_t *pq)
+static uint8_t InitializeQueue(Queue_t *pq)
 {
 	pq->head = 0 ;
-	pq->tail = -1 ; // As when we add new element we will increase rear by one (tail = 0) and add element .
-	pq->size_ = 0 ;
+	pq->tail = 0 ;
 	
 	return 1 ;
 }
 
 
-static inline uint8_t Append(QueueEntry e , volatile Queue_t *pq)
+static inline uint8_t Append(QueueEntry e , Queue_t *pq)
 {
-	pq->tail = (pq->tail +1) % MAXQUEUE ;  // if tail == MAXQUEUE then tail will be 0 .
-	pq->entry[pq->tail] = e ;
-	pq->size_++ ;
+	// Producer side : store the entry before publishing it by moving tail .
+	uint8_t tail = pq->tail ;
+	
+	pq->entry[tail & pq->mask] = e ;
+	pq->tail = tail + 1 ;
 	
 	return 1 ;
 }
 
-static inline uint8_t Serve(QueueEntry *pe ,volatile  Queue_t *pq)
+static inline uint8_t Serve(QueueEntry *pe , Queue_t *pq)
 {
-	*pe = pq->entry[pq->head] ;
-	pq->head = (pq->head + 1) % MAXQUEUE ;
-	pq->size_--;
+	// Consumer side : take the entry before releasing it by moving head .
+	uint8_t head = pq->head ;
+	
+	*pe = pq->entry[head & pq->mask] ;
+	pq->head = head + 1 ;
 	
 	return 1 ;
 }
 
-static inline uint8_t QueueEmpty(volatile Queue_t *pq)
+static inline uint8_t QueueEmpty(Queue_t *pq)
 {
-   return (!pq->size_) ;	
+   return (pq->head == pq->tail) ;	
 } 
 
-static inline uint8_t QueueFull( volatile Queue_t *pq) 
+static inline uint8_t QueueFull( Queue_t *pq) 
 {
-	return (pq->size_ == MAXQUEUE ) ;
+	return ( (uint8_t)(pq->tail - pq->head) > pq->mask ) ;
 }
 
-static inline uint8_t all_served(volatile Queue_t *pq)
-{
-	if(pq->head == 0 && (pq->size_ == MAXQUEUE) ) return 1 ;  
-	return (pq->head  == pq->size_ ) ;
-} 
 
-
-static inline uint8_t ClearQueue(volatile Queue_t *pq)
+static inline uint8_t ClearQueue(Queue_t *pq)
 {
-	pq->head = 0 ;
-	pq->tail = -1 ;
-	pq->size_ = 0 ;
+	// Consumer side : drop everything queued so far .
+	pq->head = pq->tail ;
 	
 	return 1 ;
 } 
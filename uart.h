@@ -18,9 +18,11 @@
 
 #include <stdint.h>
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 
 /* ==================== Constant ================================= */
-#ifdef  __AVR_ATmega644P__
+// ATmega644P / ATmega1284P : USART0 .
+#if defined(__AVR_ATmega644P__) || defined(__AVR_ATmega1284P__)
    #define UBRRL            UBRR0L
    #define UBRRH            UBRR0H
    #define UDR              UDR0
@@ -30,6 +32,7 @@
    #define RXC              RXC0
    #define UDRE             UDRE0
    #define FE               FE0
+   #define U2X              U2X0
    #define RXEN             RXEN0
    #define TXEN             TXEN0
    #define RXCIE            RXCIE0
@@ -38,13 +41,62 @@
    #define USART_UDRE_vect  USART0_UDRE_vect
 #endif   
 
+#ifndef F_CPU
+   #define F_CPU 8000000UL
+#endif
+
 #define DATA_REG          UDR
-#define MAXQUEUE          32
-#define MAX_RECV_CH       (MAXQUEUE)
-#define MAX_TRANS_CH      (MAXQUEUE)
+#define UART_MAX_ERROR    20   // Baud rate error limit , per mille .
+
+// Buffer sizes per direction , override them on the compiler command line (e.g. -DUART_TX_SIZE=128
+// for telemetry , -DUART_TX_SIZE=8 -DUART_RX_SIZE=8 for a bootloader) .
+#ifndef UART_RX_SIZE
+   #define UART_RX_SIZE   32
+#endif
+#ifndef UART_TX_SIZE
+   #define UART_TX_SIZE   32
+#endif
+#ifndef UART_TX_TIMEOUT
+   #define UART_TX_TIMEOUT   0   // ms put_TransBuffer_data() waits for room , 0 : drop when full .
+#endif
+
+#define MAX_RECV_CH       (UART_RX_SIZE)
+#define MAX_TRANS_CH      (UART_TX_SIZE)
+
+#if (UART_RX_SIZE & (UART_RX_SIZE - 1)) || (UART_RX_SIZE > 128) || (UART_TX_SIZE & (UART_TX_SIZE - 1)) || (UART_TX_SIZE > 128)
+   #error "UART_RX_SIZE / UART_TX_SIZE must be powers of 2 , at most 128"
+#endif
 
 
+/* ==================== Types ================================= */
+
+typedef void (*UART_RX_HOOK)(uint8_t data) ;
+typedef void (*UART_TX_DONE)(void) ;
+
 /* ==================== Macros ================================= */
+
+// Baud rate error of the setting Uart_init() picks , per mille rounded up , for constant rates :
+//   UART_BAUD_CHECK(38400) ;   at file scope , fails the build when Uart_init(38400) would fail .
+// 1000 when Uart_init() has no setting : rate 0 , above clk/8 , or UBRR out of range for a divider .
+#define UART_DIV_N(BAUD , DIV)      ( ((F_CPU) + (DIV) * (BAUD) / 2) / ((DIV) * (BAUD)) )   // UBRR + 1 , rounded
+#define UART_DIV_ERROR(BAUD , DIV)  ( (UART_DIV_N(BAUD , DIV) == 0 || UART_DIV_N(BAUD , DIV) > 4096) ? 1000UL : \
+                                      ( ( (F_CPU) > UART_DIV_N(BAUD , DIV) * (DIV) * (BAUD) ? \
+                                          (F_CPU) - UART_DIV_N(BAUD , DIV) * (DIV) * (BAUD) : \
+                                          UART_DIV_N(BAUD , DIV) * (DIV) * (BAUD) - (F_CPU) ) \
+                                        + (F_CPU) / 1000UL - 1 ) / ((F_CPU) / 1000UL) )
+#define UART_BAUD_ERROR(BAUD)       ( ((BAUD) == 0 || (BAUD) > (F_CPU) / 8UL) ? 1000UL : \
+                                      UART_DIV_ERROR(BAUD , 16UL) < UART_DIV_ERROR(BAUD , 8UL) ? \
+                                      UART_DIV_ERROR(BAUD , 16UL) : UART_DIV_ERROR(BAUD , 8UL) )
+#define UART_BAUD_CHECK(BAUD)       _Static_assert(UART_BAUD_ERROR(BAUD) <= UART_MAX_ERROR , "baud rate error over 2 %")
+
+
+// Formatted output into the transmit buffer , the format string stays in flash .
+//   %d %u %x %c , l prefix for 32-bit d/u/x , 0 flag and a one digit width (%04x) ,
+//   hex digits are upper case (%X is the same as %x)
+//   %s string in RAM , %S string in flash
+//   %q 16.16 fixed point (int32_t) , 4 decimals
+#define Uart_Printf(FMT , ...)  Uart_Printf_P(PSTR(FMT) , ##__VA_ARGS__)
+
 #define SETBIT(MEM , BIT)   ( (MEM) |= (1<< (BIT)) )
 #define CLEARBIT(MEM , BIT) ( (MEM) &=~(1<< (BIT)) )
 
@@ -56,17 +108,26 @@
 /* ==================== Functions Prototypes =========================*/
 
 
-uint8_t Uart_init(uint16_t b_rate) ;
+uint8_t Uart_init(uint32_t b_rate) ;
 uint8_t Uart_Disable(void) ;
 char get_RecvBuffer_data(void) ;
 uint8_t put_TransBuffer_data(char data) ;
 uint8_t put_TransBuffer_String(char *str) ;
+uint16_t put_TransBuffer_Block(const uint8_t *buf , uint16_t len) ;
+uint8_t Uart_Transmit_Buffer(const uint8_t *buf , uint16_t len , UART_TX_DONE done) ;
+uint8_t Uart_Tx_Block_Busy(void) ;
 
 // These functions used to receive and transmit without interrupt  
 uint8_t Uart_Transimit_chr(char ch) ;
 uint8_t Uart_Transimit_String(char *str) ;
 char Uart_Receive_chr(uint8_t wait) ;
 uint8_t Uart_Receive_String(char *str) ;
+void Uart_Set_Tx_Timeout(uint16_t ms) ;
+uint16_t Uart_Rx_Overflows(void) ;
+uint16_t Uart_Tx_Overflows(void) ;
+uint8_t Uart_Tx_Free(void) ;
 void Uart_Newline(void);
 void Uart_Print_Int(int num) ;
+void Uart_Printf_P(const char *fmt , ...) ;
+void Uart_Set_Rx_Hook(UART_RX_HOOK hook) ;
 #endif /* UART_H_ */
\ No newline at end of file
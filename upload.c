@@ -0,0 +1,254 @@
+/*
+ * upload.c
+ *
+ * Created: 10/19/2026
+ *
+ * Application upload over the UART . The receive ISR parses frames and
+ * checks their CRC , upload_run() programs DATA pages through the flash
+ * pipeline and answers every frame .
+ */
+
+#ifndef F_CPU
+       #define F_CPU 8000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/delay.h>
+#include <util/crc16.h>
+
+#include "uart.h"
+#include "flash.h"
+#include "image.h"
+#include "upload.h"
+
+#define RX_SYNC     0
+#define RX_TYPE     1
+#define RX_SEQ      2
+#define RX_LEN_LO   3
+#define RX_LEN_HI   4
+#define RX_DATA     5
+#define RX_CRC_LO   6
+#define RX_CRC_HI   7
+
+typedef struct
+{
+	uint8_t type ;
+	uint8_t seq ;
+	uint16_t len ;
+	uint8_t ok ;               // CRC matched
+	volatile uint8_t ready ;   // Set by the ISR , cleared once upload_run() is done with the buffer
+	uint8_t data[SPM_PAGESIZE] ;
+}UPLOAD_FRAME ;
+
+static UPLOAD_FRAME frames[2] ;
+static uint8_t rx_frame ;   // Buffer the ISR fills next
+static uint8_t rx_state , rx_type , rx_seq , rx_drop , rx_crc_lo ;
+static uint16_t rx_len , rx_count , rx_crc ;
+
+static void upload_rx( uint8_t ch )
+{
+	// Called from the UART receive ISR with every byte .
+	UPLOAD_FRAME *f = &frames[rx_frame] ;
+
+	// avr-libc's table-free assembler version of upload_crc16() , this runs for every byte at UPLOAD_BAUD .
+	if(rx_state != RX_CRC_LO && rx_state != RX_CRC_HI)
+	   rx_crc = _crc_xmodem_update(rx_crc , ch) ;
+
+	switch(rx_state)
+	{
+		case RX_SYNC :
+			if(ch == UPLOAD_SOF)
+			{
+				rx_crc = 0xFFFF ;
+				rx_drop = f->ready ;   // Both buffers busy , the host will time out and resend .
+				rx_state = RX_TYPE ;
+			}
+			break ;
+
+		case RX_TYPE :
+			rx_type = ch ;
+			rx_state = RX_SEQ ;
+			break ;
+
+		case RX_SEQ :
+			rx_seq = ch ;
+			rx_state = RX_LEN_LO ;
+			break ;
+
+		case RX_LEN_LO :
+			rx_len = ch ;
+			rx_state = RX_LEN_HI ;
+			break ;
+
+		case RX_LEN_HI :
+			rx_len |= (uint16_t)ch << 8 ;
+			rx_count = 0 ;
+			// Longer than a page : not a frame , look for the next SOF .
+			rx_state = (rx_len > SPM_PAGESIZE) ? RX_SYNC : rx_len ? RX_DATA : RX_CRC_LO ;
+			break ;
+
+		case RX_DATA :
+			if(!rx_drop)
+			   f->data[rx_count] = ch ;
+			if(++rx_count == rx_len)
+			   rx_state = RX_CRC_LO ;
+			break ;
+
+		case RX_CRC_LO :
+			rx_crc_lo = ch ;
+			rx_state = RX_CRC_HI ;
+			break ;
+
+		case RX_CRC_HI :
+			if(!rx_drop)
+			{
+				f->type = rx_type ;
+				f->seq = rx_seq ;
+				f->len = rx_len ;
+				f->ok = ( (rx_crc_lo | (uint16_t)ch << 8) == rx_crc ) ;
+				f->ready = 1 ;
+				rx_frame ^= 1 ;
+			}
+			rx_state = RX_SYNC ;
+			break ;
+	}
+}
+
+static uint8_t line_active(void)
+{
+	// 1 if RXD goes low (a start bit) within UPLOAD_SENSE_MS , the pull-up keeps an open line high .
+	// About 8 cycles a sample , a start bit at UPLOAD_BAUD lasts F_CPU / UPLOAD_BAUD cycles .
+	uint16_t n = UPLOAD_SENSE_MS * (F_CPU / 8000UL) ;
+	uint8_t seen = 0 ;
+
+	UPLOAD_RXD_PORT |= (1<<UPLOAD_RXD_BIT) ;
+	while(n-- && !seen)
+	   seen = !(UPLOAD_RXD_PIN & (1<<UPLOAD_RXD_BIT)) ;
+	UPLOAD_RXD_PORT &= ~(1<<UPLOAD_RXD_BIT) ;
+
+	return seen ;
+}
+
+static void upload_reply( uint8_t type , uint8_t seq , uint8_t status )
+{
+	uint16_t crc = upload_crc16(upload_crc16(upload_crc16(0xFFFF , type) , seq) , status) ;
+
+	Uart_Transimit_chr(UPLOAD_SOF) ;
+	Uart_Transimit_chr(type) ;
+	Uart_Transimit_chr(seq) ;
+	Uart_Transimit_chr(status) ;
+	Uart_Transimit_chr(crc) ;
+	Uart_Transimit_chr(crc >> 8) ;
+}
+
+uint8_t upload_run( uint32_t flash_end , IMAGE_INFO *image )
+{
+	// Waits UPLOAD_WAIT_MS for a HELLO when the line is busy , then programs the image the host sends .
+	uint8_t main_frame = 0 , started = 0 , result = UPLOAD_NONE ;
+	uint16_t page = 0 , idle = 0 ;
+
+	if(!line_active())
+	   return UPLOAD_NONE ;
+
+	rx_state = RX_SYNC ;
+	rx_frame = 0 ;
+	frames[0].ready = frames[1].ready = 0 ;
+	Uart_Set_Rx_Hook(upload_rx) ;
+
+	while(1)
+	{
+		UPLOAD_FRAME *f = &frames[main_frame] ;
+
+		// 1- Next frame , in the order the ISR received them (about 100 us per idle loop) .
+		if(!f->ready)
+		{
+			flash_poll() ;
+			_delay_us(100) ;
+			if(++idle >= (started ? UPLOAD_TIMEOUT_MS : UPLOAD_WAIT_MS) * 10U)
+			{
+				if(started) result = UPLOAD_FAILED ;
+				break ;
+			}
+			continue ;
+		}
+		idle = 0 ;
+
+		// 2- Answer it . Until a HELLO is accepted everything else is line noise .
+		if(!f->ok)
+		{
+			if(started) upload_reply(UPLOAD_NAK , (uint8_t)page , UPLOAD_ST_BAD_FRAME) ;
+		}
+		else if(f->type == UPLOAD_HELLO)
+		{
+			uint32_t crc = image->crc ;
+			uint8_t st = (f->len == IMG_HDR_SIZE) ? image_parse_header(f->data , flash_end , image) : IMG_BAD_HEADER ;
+
+			if(st != IMG_OK || (image->flags & IMG_FLAG_IHEX))
+			{
+				upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_BAD_IMAGE) ;
+				result = UPLOAD_FAILED ;
+				break ;
+			}
+			if(image_is_flashed(image))
+			{
+				upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_SAME) ;
+				result = UPLOAD_DONE ;
+				break ;
+			}
+			// A repeated HELLO for the same image keeps the pages already received .
+			if(!started || image->crc != crc)
+			{
+				image_forget() ;
+				started = 1 ;
+				page = 0 ;
+			}
+			upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_OK) ;
+		}
+		else if(started && f->type == UPLOAD_DATA)
+		{
+			int8_t ahead = (int8_t)(f->seq - (uint8_t)page) ;
+
+			if(!ahead && page < image->pages && f->len == SPM_PAGESIZE)
+			{
+				// Answer once the page is in the SPM buffer , this buffer takes the frame after next .
+				flash_queue(image->load + (uint32_t)page * SPM_PAGESIZE , f->data) ;
+				while(flash_queued()) flash_poll() ;
+				page++ ;
+				upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_OK) ;
+			}
+			else if(ahead < 0)
+			   upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_OK) ;   // Programmed before , its ACK got lost .
+			else
+			   upload_reply(UPLOAD_NAK , (uint8_t)page , UPLOAD_ST_BAD_FRAME) ;
+		}
+		else if(started && f->type == UPLOAD_END)
+		{
+			if(page != image->pages)
+			   upload_reply(UPLOAD_NAK , (uint8_t)page , UPLOAD_ST_BAD_FRAME) ;
+			else
+			{
+				// 3- Read the programmed pages back , remember the image only if they match its CRC .
+				flash_flush() ;
+				if(image_flash_crc(image) == image->crc)
+				{
+					image_mark_flashed(image) ;
+					upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_OK) ;
+					result = UPLOAD_DONE ;
+				}
+				else
+				{
+					upload_reply(UPLOAD_ACK , f->seq , UPLOAD_ST_VERIFY) ;
+					result = UPLOAD_FAILED ;
+				}
+				break ;
+			}
+		}
+
+		f->ready = 0 ;
+		main_frame ^= 1 ;
+	}
+
+	flash_flush() ;
+	Uart_Set_Rx_Hook(0) ;
+	return result ;
+}
@@ -0,0 +1,46 @@
+/*
+ * upload.h
+ *
+ * Created: 10/19/2026
+ *
+ * Application upload over the UART (see uploadfmt.h , host side is
+ * tools/upload.c) . Frames are received by the UART ISR into two page
+ * buffers while the previous page is erased and written , the vectors must
+ * be in the boot section (flash_boot_vectors(1)) and the UART initialised
+ * at UPLOAD_BAUD with interrupts on .
+ *
+ * A boot without a host costs UPLOAD_SENSE_MS only : the bootloader listens
+ * for a HELLO only when it sees start bits on RXD , the host sends HELLO
+ * back to back while it waits for the board .
+ */
+
+
+#ifndef UPLOAD_H_
+#define UPLOAD_H_
+
+#include <stdint.h>
+
+#include "image.h"
+#include "uploadfmt.h"
+
+/*========== Constants ==========================*/
+
+#define UPLOAD_SENSE_MS     2      // Look this long for line activity , longer than the host's gap between HELLOs .
+#define UPLOAD_WAIT_MS      100    // Then listen this long for a complete HELLO .
+#define UPLOAD_TIMEOUT_MS   2000   // Give up when the host goes quiet in the middle of an upload .
+
+// upload_run() results
+#define UPLOAD_NONE         0   // No host
+#define UPLOAD_DONE         1   // Image programmed and verified , or already in flash
+#define UPLOAD_FAILED       2   // Refused image , verify error or host gone , flash may be partly written
+
+#define UPLOAD_RXD_PORT     PORTD  // RXD pin , PD0 on ATmega32 / ATmega644P / ATmega1284P
+#define UPLOAD_RXD_PIN      PIND
+#define UPLOAD_RXD_BIT      PD0
+
+/*========== Functions prototypes ==========================*/
+
+uint8_t upload_run( uint32_t flash_end , IMAGE_INFO *image ) ;
+
+
+#endif /* UPLOAD_H_ */
@@ -0,0 +1,70 @@
+/*
+ * uploadfmt.h
+ *
+ * Created: 10/19/2026
+ *
+ * UART upload protocol . Shared by upload.c and tools/upload.c .
+ *
+ *  frame  : SOF , type , seq , len (2 bytes) , len data bytes , CRC (2 bytes)
+ *  reply  : SOF , type , seq , status , CRC (2 bytes)
+ *
+ * CRC is CRC-16/CCITT (poly 0x1021 , init 0xFFFF , not reflected) over
+ * everything between SOF and the CRC .
+ *
+ *  HELLO  : data = image header (see imgfmt.h) , seq 0 . Starts (again) an
+ *           upload , the host repeats it until it is answered .
+ *  DATA   : data = one flash page , page n of the image has seq n & 0xFF .
+ *  END    : no data , after the last page . The reply comes once the image
+ *           is verified in flash .
+ *
+ * Every frame is answered with ACK (frame accepted , or a duplicate of one
+ * accepted before) or NAK (bad CRC or out of order , seq = next expected
+ * page) . The host keeps up to UPLOAD_WINDOW DATA frames unanswered , on a
+ * NAK or timeout it goes back to the first unanswered page . A DATA frame is
+ * answered once its page is in the SPM buffer , so the page the device is
+ * programming and the one it is receiving never share a buffer .
+ *
+ * All multi-byte fields are little-endian .
+ */
+
+
+#ifndef UPLOADFMT_H_
+#define UPLOADFMT_H_
+
+#include <stdint.h>
+
+/*========== Constants ==========================*/
+
+#ifndef UPLOAD_BAUD
+   #define UPLOAD_BAUD          500000  // Exact at 8 MHz (U2X) , page programming stays the limit
+#endif
+#define UPLOAD_WINDOW           2
+#define UPLOAD_SOF              0xA5
+
+// Frame types
+#define UPLOAD_HELLO            'H'
+#define UPLOAD_DATA             'D'
+#define UPLOAD_END              'E'
+#define UPLOAD_ACK              'A'
+#define UPLOAD_NAK              'N'
+
+// Reply status
+#define UPLOAD_ST_OK            0
+#define UPLOAD_ST_SAME          1   // HELLO : image is already flashed , nothing to send
+#define UPLOAD_ST_BAD_IMAGE     2   // HELLO : header refused (see image_parse_header()) or Intel HEX image
+#define UPLOAD_ST_VERIFY        3   // END : flash content does not match the image CRC
+#define UPLOAD_ST_BAD_FRAME     4   // NAK : CRC error , wrong length or unexpected frame
+
+/*========== Functions ==========================*/
+
+// CRC-16/CCITT of one byte , same as avr-libc _crc_xmodem_update() with init 0xFFFF .
+static inline uint16_t upload_crc16(uint16_t crc , uint8_t data)
+{
+	crc ^= (uint16_t)data << 8 ;
+	for(uint8_t i = 0 ; i<8 ; i++)
+	   crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1 ;
+	return crc ;
+}
+
+
+#endif /* UPLOADFMT_H_ */